@@ -0,0 +1,168 @@
+// Compares keyword/operator classification with the old per-lexer std::unordered_map tables against
+// classify_builtin() on the lexemes of the test_files corpus.
+//
+// Usage: classify_bench [iterations] [file.src...]
+
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lexer.h"
+#include "sourcebuffer.h"
+
+#ifndef TEST_FILES_DIR
+#define TEST_FILES_DIR "test_files"
+#endif
+
+using enum TokenType;
+
+// The tables and lookups the lexer used before classify_builtin()
+struct MapClassifier {
+    std::unordered_map<std::string, TokenType> keywords = {
+            {"int", INT}, {"while", WHILE}, {"float", FLOAT}, {"local", LOCAL}, {"if", IF}, {"void", VOID},
+            {"constructor", CONSTRUCTOR}, {"then", THEN}, {"class", CLASS}, {"else", ELSE},
+            {"attribute", ATTRIBUTE}, {"function", FUNCTION}, {"self", SELF}, {"read", READ},
+            {"public", PUBLIC}, {"isa", ISA}, {"write", WRITE}, {"implementation", IMPLEMENTATION},
+            {"return", RETURN}, {"private", PRIVATE},
+    };
+    std::unordered_map<std::string, TokenType> operators = {
+            {"==", EQ}, {"<>", NEQ}, {"<", LT}, {">", GT}, {"<=", LTEQ}, {">=", GTEQ}, {"+", ADD}, {"-", SUB},
+            {"*", MUL}, {"/", DIV}, {":=", ASSIGN}, {"or", OR}, {"and", AND}, {"not", NOT},
+    };
+    std::unordered_map<std::string, TokenType> punctuation = {
+            {",", COMMA}, {";", SEMICOLON}, {"(", LPAREN}, {")", RPAREN}, {"{", LBRACE}, {"}", RBRACE},
+            {"[", LBRACKET}, {"]", RBRACKET}, {".", DOT}, {":", COLON}, {"=>", ARROW},
+    };
+
+    TokenType word(std::string_view lexeme) {
+        std::string str(lexeme);
+        if (keywords.find(str) != keywords.end()) {
+            return keywords[str];
+        }
+        if (operators.find(str) != operators.end()) {
+            return operators[str];
+        }
+        return IDENTIFIER;
+    }
+
+    TokenType symbol(std::string_view candidate) {
+        std::string str{candidate[0]};
+        if (candidate.size() > 1) {
+            std::string doubleCharOp = str + candidate[1];
+            if (operators.find(doubleCharOp) != operators.end()) {
+                return operators[doubleCharOp];
+            }
+            if (punctuation.find(doubleCharOp) != punctuation.end()) {
+                return punctuation[doubleCharOp];
+            }
+        }
+        if (operators.find(str) != operators.end()) {
+            return operators[str];
+        }
+        if (punctuation.find(str) != punctuation.end()) {
+            return punctuation[str];
+        }
+        return INVALID_CHAR;
+    }
+};
+
+TokenType table_symbol(std::string_view candidate) {
+    if (candidate.size() > 1) {
+        TokenType type = classify_builtin(candidate, INVALID_CHAR);
+        if (type != INVALID_CHAR) {
+            return type;
+        }
+    }
+    return classify_builtin(candidate.substr(0, 1), INVALID_CHAR);
+}
+
+bool is_word(TokenType type) {
+    return type == IDENTIFIER || (type >= INT && type <= PRIVATE) || type == OR || type == AND || type == NOT;
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 2000;
+    std::vector<std::string> filenames;
+    for (int i = 2; i < argc; i++) {
+        filenames.emplace_back(argv[i]);
+    }
+    if (filenames.empty()) {
+        for (const auto &entry: std::filesystem::directory_iterator(TEST_FILES_DIR)) {
+            if (entry.path().extension() == ".src") {
+                filenames.push_back(entry.path().string());
+            }
+        }
+    }
+
+    // Collect the lexemes that go through classification, the same way the lexer sees them
+    std::vector<SourceBuffer> sources(filenames.size());
+    std::vector<std::string_view> words;
+    std::vector<std::string_view> symbols;
+    for (std::size_t i = 0; i < filenames.size(); i++) {
+        if (!sources[i].open(filenames[i])) {
+            std::cerr << "Could not open file " << filenames[i] << std::endl;
+            return 1;
+        }
+        const std::string_view text = sources[i].view();
+        Lexer lexer(text);
+        for (Token token = lexer.nextToken(); token.type != EOF_TOKEN; token = lexer.nextToken()) {
+            if (is_word(token.type)) {
+                words.push_back(token.value);
+            }
+            else if (token.type != INTLIT && token.type != FLOATLIT && token.type != INVALID_NUMBER &&
+                     token.type != INVALID_ID && !token.value.empty()) {
+                // Two characters starting at the token, as the lexer peeks them
+                std::size_t offset = token.value.data() - text.data();
+                symbols.push_back(text.substr(offset, 2));
+            }
+        }
+    }
+
+    MapClassifier maps;
+    for (auto word: words) {
+        if (maps.word(word) != classify_builtin(word, IDENTIFIER)) {
+            std::cerr << "Mismatch on " << word << std::endl;
+            return 1;
+        }
+    }
+    for (auto symbol: symbols) {
+        if (maps.symbol(symbol) != table_symbol(symbol)) {
+            std::cerr << "Mismatch on " << symbol << std::endl;
+            return 1;
+        }
+    }
+
+    auto run = [&](const char *name, auto &&word, auto &&symbol) {
+        long checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            for (auto w: words) {
+                checksum += static_cast<int>(word(w));
+            }
+            for (auto s: symbols) {
+                checksum += static_cast<int>(symbol(s));
+            }
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        double lookups = static_cast<double>(iterations) * static_cast<double>(words.size() + symbols.size());
+        std::cout << std::left << std::setw(16) << name << std::right << std::setw(10) << std::fixed
+                  << std::setprecision(2) << elapsed / lookups << " ns/lexeme  " << std::setw(8)
+                  << std::setprecision(1) << lookups / elapsed * 1e3 << " M lexemes/s  (checksum " << checksum
+                  << ")" << std::endl;
+        return elapsed;
+    };
+
+    std::cout << filenames.size() << " files, " << words.size() << " words, " << symbols.size() << " symbols, "
+              << iterations << " iterations" << std::endl;
+    std::cout << "perfect hash: " << spelling_hash::params.size << " slots, multiplier "
+              << spelling_hash::params.multiplier << std::endl;
+    double old_time = run("unordered_map", [&](auto w) { return maps.word(w); },
+                          [&](auto s) { return maps.symbol(s); });
+    double new_time = run("classify_builtin", [](auto w) { return classify_builtin(w, IDENTIFIER); },
+                          [](auto s) { return table_symbol(s); });
+    std::cout << "speedup: " << std::setprecision(2) << old_time / new_time << "x" << std::endl;
+    return 0;
+}
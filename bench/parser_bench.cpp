@@ -0,0 +1,156 @@
+// Measures the cost of parsing per token, without derivation output, over the test_files corpus or the given files.
+// The lexing cost is measured separately and subtracted, so the result is the time spent in the parser itself.
+// The FIRST/FOLLOW check skipErrors() makes is also timed on its own, with the std::unordered_set temporaries the
+// parser built on every call before TokenSet, against the TokenSet constants.
+//
+// Usage: parser_bench [iterations] [file.src...]
+
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <initializer_list>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "lexer.h"
+#include "parser.h"
+#include "sourcebuffer.h"
+#include "tokenset.h"
+
+#ifndef TEST_FILES_DIR
+#define TEST_FILES_DIR "test_files"
+#endif
+
+using enum TokenType;
+
+// FIRST and FOLLOW sets of the skipErrors() calls in the parser before TokenSet, spelled as they were at the call sites
+struct SetPair {
+    std::initializer_list<TokenType> first;
+    std::initializer_list<TokenType> follow;
+};
+
+const SetPair set_pairs[] = {
+        {{CLASS, IMPLEMENTATION, FUNCTION, EPSILON}, {EOF_TOKEN}},
+        {{PUBLIC, PRIVATE, EPSILON}, {RBRACE}},
+        {{ISA, EPSILON}, {LBRACE}},
+        {{COMMA, EPSILON}, {LBRACE}},
+        {{FUNCTION, CONSTRUCTOR, EPSILON}, {RBRACE}},
+        {{IDENTIFIER, EPSILON}, {RPAREN}},
+        {{COMMA, EPSILON}, {RPAREN}},
+        {{LOCAL, IDENTIFIER, SELF, IF, WHILE, READ, WRITE, RETURN, EPSILON}, {RBRACE}},
+        {{IF, WHILE, READ, WRITE, RETURN, IDENTIFIER, SELF, EPSILON}, {RBRACE}},
+        {{LBRACE, IF, WHILE, READ, WRITE, RETURN, IDENTIFIER, SELF, EPSILON}, {ELSE, SEMICOLON}},
+        {{INTLIT, FLOATLIT, IDENTIFIER, LPAREN, ADD, SUB, NOT, SELF, EPSILON}, {RPAREN}},
+        {{LPAREN, LBRACKET, DOT, EPSILON}, {RPAREN}},
+        {{LPAREN, LBRACKET, EPSILON}, {RPAREN, DOT}},
+        {{DOT, EPSILON}, {SEMICOLON}},
+        {{DOT, EPSILON}, {RPAREN}},
+        {{IDENTIFIER}, {}},
+};
+
+// The check as the parser made it before: both sets are built as temporaries for every call
+bool set_check(TokenType type, const SetPair &pair) {
+    const std::unordered_set<TokenType> first = pair.first;
+    const std::unordered_set<TokenType> follow = pair.follow;
+    return first.contains(type) || (first.contains(EPSILON) && follow.contains(type));
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 200;
+    std::vector<std::string> filenames;
+    for (int i = 2; i < argc; i++) {
+        filenames.emplace_back(argv[i]);
+    }
+    if (filenames.empty()) {
+        for (const auto &entry: std::filesystem::directory_iterator(TEST_FILES_DIR)) {
+            if (entry.path().extension() == ".src") {
+                filenames.push_back(entry.path().string());
+            }
+        }
+    }
+
+    std::vector<SourceBuffer> sources(filenames.size());
+    std::vector<TokenType> types; // Of every token in the corpus, the checks are made against them
+    long tokens = 0;
+    for (std::size_t i = 0; i < filenames.size(); i++) {
+        if (!sources[i].open(filenames[i])) {
+            std::cerr << "Could not open file " << filenames[i] << std::endl;
+            return 1;
+        }
+        Lexer lexer(sources[i].view());
+        for (Token token = lexer.nextToken(); token.type != EOF_TOKEN; token = lexer.nextToken()) {
+            types.push_back(token.type);
+            tokens++;
+        }
+    }
+
+    // Every output goes to a stream without a buffer, which drops it
+    std::ostream null(nullptr);
+
+    auto time = [&](auto &&body) {
+        long checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            for (const auto &source: sources) {
+                checksum += body(source.view());
+            }
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        return std::make_pair(elapsed / (static_cast<double>(iterations) * static_cast<double>(tokens)), checksum);
+    };
+
+    auto [lex_time, lex_checksum] = time([](std::string_view text) {
+        long count = 0;
+        Lexer lexer(text);
+        while (lexer.nextToken().type != EOF_TOKEN) {
+            count++;
+        }
+        return count;
+    });
+    auto [parse_time, parse_checksum] = time([&](std::string_view text) {
+        CompilationContext context;
+        Parser parser(Lexer(text), context, null, null, DerivationMode::OFF);
+        parser.parse();
+        return parser.has_error ? 1L : 0L;
+    });
+
+    // Every token is checked against one of the set pairs in turn
+    auto time_checks = [&](auto &&check) {
+        long checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            for (std::size_t t = 0; t < types.size(); t++) {
+                checksum += check(types[t], t % std::size(set_pairs));
+            }
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        return std::make_pair(elapsed / (static_cast<double>(iterations) * static_cast<double>(tokens)), checksum);
+    };
+    std::vector<std::pair<TokenSet, TokenSet>> token_sets;
+    for (const auto &pair: set_pairs) {
+        token_sets.emplace_back(TokenSet(pair.first), TokenSet(pair.follow));
+    }
+    auto [set_time, set_checksum] = time_checks([](TokenType type, std::size_t pair) {
+        return set_check(type, set_pairs[pair]) ? 1L : 0L;
+    });
+    auto [bits_time, bits_checksum] = time_checks([&](TokenType type, std::size_t pair) {
+        const auto &[first, follow] = token_sets[pair];
+        return first.contains(type) || (first.contains(EPSILON) && follow.contains(type)) ? 1L : 0L;
+    });
+
+    std::cout << filenames.size() << " files, " << tokens << " tokens, " << iterations << " iterations" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "lex only    " << std::setw(10) << lex_time << " ns/token  (checksum " << lex_checksum << ")"
+              << std::endl;
+    std::cout << "lex + parse " << std::setw(10) << parse_time << " ns/token  (checksum " << parse_checksum << ")"
+              << std::endl;
+    std::cout << "parse       " << std::setw(10) << parse_time - lex_time << " ns/token" << std::endl;
+    std::cout << "FIRST/FOLLOW check, unordered_set " << std::setw(10) << set_time << " ns/check  (checksum "
+              << set_checksum << ")" << std::endl;
+    std::cout << "FIRST/FOLLOW check, TokenSet      " << std::setw(10) << bits_time << " ns/check  (checksum "
+              << bits_checksum << ")" << std::endl;
+    std::cout << "speedup: " << std::setprecision(2) << set_time / bits_time << "x" << std::endl;
+    return 0;
+}
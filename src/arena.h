@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Bump allocator for objects that all die together, like the nodes of the AST. Objects are carved out of a few large
+ * blocks and are never freed one by one: the blocks are returned all at once when the arena is released.
+ *
+ * Types with an allocator_type are given the arena allocator, so their containers grow inside the arena as well.
+ * Destructors of objects that own memory outside the arena run in a flat loop on release, newest first. Types that are
+ * trivially destructible, like the nodes of the AST with their ArenaVector of children, cost nothing on release.
+ */
+class Arena {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+    explicit Arena(std::size_t initial_block_size = 64 * 1024) : resource(initial_block_size) {}
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    ~Arena() {
+        release();
+    }
+
+    /**
+     * Constructs an object in the arena
+     * @param args constructor arguments, the arena allocator is appended when T accepts one
+     * @return the object, owned by the arena
+     */
+    template<typename T, typename... Args>
+    T *make(Args &&... args) {
+        T *object = get_allocator().new_object<T>(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            destructors.push_back({object, [](void *o) { static_cast<T *>(o)->~T(); }});
+        }
+        return object;
+    }
+
+    // Destroys every object and returns the blocks, the arena can be reused afterwards
+    void release() {
+        for (auto it = destructors.rbegin(); it != destructors.rend(); ++it) {
+            it->destroy(it->object);
+        }
+        destructors.clear();
+        resource.release();
+    }
+
+    [[nodiscard]] allocator_type get_allocator() { return allocator_type(&resource); }
+
+private:
+    struct Destructor {
+        void *object;
+        void (*destroy)(void *);
+    };
+
+    std::pmr::monotonic_buffer_resource resource;
+    std::vector<Destructor> destructors;
+};
+
+/**
+ * Growable array of trivial values, kept in the memory of an arena. It has no destructor: its storage, and what it
+ * left behind when it grew, go back with the blocks of the arena, and with any other allocator they are never freed. A
+ * pmr::vector would do the same but is not trivially destructible, so whatever holds it would need its destructor run
+ * by the arena.
+ */
+template<typename T>
+class ArenaVector {
+    static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>);
+
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<T>;
+
+    explicit ArenaVector(const allocator_type &alloc) : alloc(alloc) {}
+    // Copies would share the storage
+    ArenaVector(const ArenaVector &) = delete;
+    ArenaVector &operator=(const ArenaVector &) = delete;
+
+    [[nodiscard]] std::size_t size() const { return count; }
+    [[nodiscard]] bool empty() const { return count == 0; }
+
+    T &operator[](std::size_t i) { return values[i]; }
+    const T &operator[](std::size_t i) const { return values[i]; }
+    T &front() { return values[0]; }
+    T &back() { return values[count - 1]; }
+
+    T *begin() { return values; }
+    T *end() { return values + count; }
+    const T *begin() const { return values; }
+    const T *end() const { return values + count; }
+
+    void push_back(T value) {
+        if (count == capacity) {
+            capacity = capacity == 0 ? 4 : capacity * 2;
+            T *grown = alloc.allocate(capacity);
+            if (count > 0) {
+                std::memcpy(grown, values, count * sizeof(T));
+            }
+            values = grown;
+        }
+        values[count++] = value;
+    }
+
+private:
+    allocator_type alloc;
+    T *values = nullptr;
+    std::size_t count = 0;
+    std::size_t capacity = 0;
+};
@@ -1,17 +1,19 @@
 #pragma once
 
+#include <algorithm>
+#include <cassert>
 #include <string>
 #include <iostream>
 #include <unordered_map>
-#include <memory>
+#include <memory_resource>
 #include <vector>
 
+#include "arena.h"
+#include "name.h"
 #include "symtable.h"
 
 class Visitor; // Forward declaration
 
-using std::shared_ptr;
-
 enum class ASTType {
     EMPTY, PROGRAM, CLASSDEF, ISA, IMPLDEF, MEMBERS, VISIBILITY, FUNCHEAD, CONSTRUCTOR, CLASSMEM, IMPLBODY, FUNCDEF,
     FPARAMS, FPARAM, TYPE, ARRAYSIZES, ARRAYSIZE, VARDECL, FUNCBODY, STATEMENT, SIGN, FACTOR, NOT, RELOP, STATBLOCK,
@@ -73,35 +75,42 @@ const std::unordered_map<ASTType, std::string> type_map {
 
 
 struct AST {
+    using allocator_type = ArenaVector<AST *>::allocator_type;
+
     ASTType type = ASTType::EMPTY;
-    std::string str_value;
+    Name str_value;
     int line_number = -1;
 
     AST* parent = nullptr;
-    std::vector<AST*> children;
+    ArenaVector<AST*> children;
     AST* firstSibling = nullptr;
     AST* next = nullptr;
 
-    shared_ptr<SymbolTable> symbol_table;
-    shared_ptr<Symbol> symbol;
-    std::string data_type; // Used for semantic checking
+    // Owned by the arena of the CompilationContext, like the nodes
+    SymbolTable* symbol_table = nullptr;
+    Symbol* symbol = nullptr;
+    Name data_type; // Used for semantic checking
 
-    AST() = default;
+    explicit AST(const allocator_type &alloc) : children(alloc) {};
 
-    explicit AST(int line_number) : line_number(line_number) {};
+    explicit AST(int line_number, const allocator_type &alloc = {}) : line_number(line_number), children(alloc) {};
 
     /**
      * Creates a new node and adopts all given children
      * @param type type of this node
      * @param line_number line number in the source code
      * @param children (Optional)
+     * @param alloc allocator of the children array, the arena when the node is made by Arena::make
      */
-    explicit AST(ASTType type, int line_number, std::initializer_list<AST *> children = {}) : type(type), line_number(line_number) {
+    explicit AST(ASTType type, int line_number, std::initializer_list<AST *> children = {},
+                 const allocator_type &alloc = {}) : type(type), line_number(line_number), children(alloc) {
         for (const auto& child: children) {
             adopt(child);
         }
     };
 
+    AST(ASTType type, int line_number, const allocator_type &alloc) : AST(type, line_number, {}, alloc) {};
+
     void accept(Visitor &v);
 
     /**
@@ -114,7 +123,7 @@ struct AST {
             children.back()->next = child;
             child->firstSibling = children.front();
         }
-        children.emplace_back(child);
+        children.push_back(child);
 
         return this;
     }
@@ -125,6 +134,30 @@ struct AST {
         }
     }
 
+    /**
+     * Puts another node in the place of a child, the child is left detached from the tree
+     * @param child
+     * @param replacement node without parent or siblings
+     */
+    void replace(AST *child, AST *replacement) {
+        auto it = std::find(children.begin(), children.end(), child);
+        assert(it != children.end());
+        *it = replacement;
+        replacement->parent = this;
+        replacement->next = child->next;
+        replacement->firstSibling = child->firstSibling;
+        if (it != children.begin()) {
+            (*(it - 1))->next = replacement;
+        } else {
+            for (auto sibling = replacement->next; sibling != nullptr; sibling = sibling->next) {
+                sibling->firstSibling = replacement;
+            }
+        }
+        child->parent = nullptr;
+        child->next = nullptr;
+        child->firstSibling = nullptr;
+    }
+
     /**
      * Add a sibling and all of its siblings to the end of the list
      * @param sibling
@@ -159,38 +192,35 @@ struct AST {
         if (!str_value.empty()) {
             o << ": (" << str_value << ')';
         }
-        o << std::endl;
-    }
-
-    void free() {
-        for (auto child: children) {
-            child->free();
-        }
-        delete this;
+        o << '\n';
     }
 
-    virtual ~AST() = default;
+    // Left trivial, nodes are never deleted on their own and the arena has no destructor to run for them
+    ~AST() = default;
 };
 
 struct ASTIntLit : AST {
-    ASTIntLit(int value, int line) : AST(ASTType::INTLIT, line), value(value) {};
-    explicit ASTIntLit(int line) : AST(ASTType::INTLIT, line) {};
+    ASTIntLit(int value, int line, const allocator_type &alloc = {}) : AST(ASTType::INTLIT, line, alloc), value(value) {};
+    explicit ASTIntLit(int line, const allocator_type &alloc = {}) : AST(ASTType::INTLIT, line, alloc) {};
     int value = -1;
 
     void print(std::ostream &o) override {
-        o << type_map.at(type) << ": (" << value << ')' << std::endl;
+        o << type_map.at(type) << ": (" << value << ")\n";
     }
 };
 
 struct ASTFloatLit : AST {
-    ASTFloatLit(float value, int line) : AST(ASTType::FLOATLIT, line), value(value) {};
-    explicit ASTFloatLit(int line) : AST(ASTType::FLOATLIT, line) {};
+    ASTFloatLit(float value, int line, const allocator_type &alloc = {}) : AST(ASTType::FLOATLIT, line, alloc), value(value) {};
+    explicit ASTFloatLit(int line, const allocator_type &alloc = {}) : AST(ASTType::FLOATLIT, line, alloc) {};
     float value = -1;
 
     void print(std::ostream &o) override {
-        o << type_map.at(type) << ": (" << value << ')' << std::endl;
+        o << type_map.at(type) << ": (" << value << ")\n";
     }
 };
 
+// Arena::make registers no destructor for the nodes
+static_assert(std::is_trivially_destructible_v<AST> && std::is_trivially_destructible_v<ASTIntLit> &&
+              std::is_trivially_destructible_v<ASTFloatLit>);
 
 
@@ -0,0 +1,163 @@
+#include "cfg.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "dataflow.h"
+
+using ir::Opcode;
+
+CFG::CFG(const ir::Function &function) {
+    // Every CFG built counts, the ones of the analysis cache and of the register checks as well as --emit-cfg's
+    dataflow::Timer timer("cfg", function.blocks.size());
+    const int blocks = static_cast<int>(function.blocks.size());
+    std::unordered_map<std::string, int> labels;
+    for (int block = 0; block < blocks; block++) {
+        if (!function.blocks[block].label.empty()) {
+            labels[function.blocks[block].label] = block;
+        }
+    }
+    auto target = [&](const std::string &label) {
+        auto it = labels.find(label);
+        if (it == labels.end()) {
+            throw std::runtime_error("Jump to unknown label " + label + " in " + function.label);
+        }
+        return it->second;
+    };
+
+    successor_edges.resize(blocks);
+    predecessor_edges.resize(blocks);
+    for (int block = 0; block < blocks; block++) {
+        const auto &instructions = function.blocks[block].instructions;
+        const auto last = instructions.empty() ? Opcode::COMMENT : instructions.back().op;
+        auto &successors = successor_edges[block];
+        if (last == Opcode::JUMP || last == Opcode::BRANCH_ZERO || last == Opcode::BRANCH_NONZERO) {
+            successors.push_back(target(instructions.back().label));
+        }
+        if (last != Opcode::JUMP && last != Opcode::RETURN && last != Opcode::HALT && block + 1 < blocks &&
+            std::find(successors.begin(), successors.end(), block + 1) == successors.end()) {
+            successors.push_back(block + 1);
+        }
+        for (auto successor: successors) {
+            predecessor_edges[successor].push_back(block);
+        }
+    }
+
+    // Depth-first search from the entry, a block is added once all its successors are
+    position.assign(blocks, -1);
+    if (blocks == 0) {
+        return;
+    }
+    std::vector<bool> visited(blocks, false);
+    std::vector<std::pair<int, std::size_t>> stack = {{0, 0}};
+    visited[0] = true;
+    while (!stack.empty()) {
+        auto &[block, next] = stack.back();
+        if (next < successor_edges[block].size()) {
+            const int successor = successor_edges[block][next++];
+            if (!visited[successor]) {
+                visited[successor] = true;
+                stack.emplace_back(successor, 0);
+            }
+            continue;
+        }
+        order.push_back(block);
+        stack.pop_back();
+    }
+    std::reverse(order.begin(), order.end());
+    for (std::size_t i = 0; i < order.size(); i++) {
+        position[order[i]] = static_cast<int>(i);
+    }
+    find_dominators();
+}
+
+// Cooper, Harvey and Kennedy, "A Simple, Fast Dominance Algorithm": the dominator of a block is the closest common
+// dominator of its predecessors, found walking up from both until they meet
+void CFG::find_dominators() {
+    idom.assign(size(), -1);
+    dominator_children.assign(size(), {});
+    if (order.empty()) {
+        return;
+    }
+    idom[0] = 0;
+    auto intersect = [&](int left, int right) {
+        while (left != right) {
+            while (position[left] > position[right]) {
+                left = idom[left];
+            }
+            while (position[right] > position[left]) {
+                right = idom[right];
+            }
+        }
+        return left;
+    };
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (std::size_t i = 1; i < order.size(); i++) {
+            const int block = order[i];
+            int dominator = -1;
+            for (auto predecessor: predecessor_edges[block]) {
+                if (idom[predecessor] != -1) {
+                    dominator = dominator == -1 ? predecessor : intersect(predecessor, dominator);
+                }
+            }
+            if (idom[block] != dominator) {
+                idom[block] = dominator;
+                changed = true;
+            }
+        }
+    }
+    for (std::size_t i = 1; i < order.size(); i++) {
+        dominator_children[idom[order[i]]].push_back(order[i]);
+    }
+}
+
+bool CFG::dominates(int dominator, int block) const {
+    if (!reachable(block)) {
+        return false;
+    }
+    while (block != dominator && block != 0) {
+        block = idom[block];
+    }
+    return block == dominator;
+}
+
+std::vector<Loop> CFG::loops() const {
+    std::vector<Loop> result;
+    for (auto header: order) {
+        // Blocks reaching the sources of the back edges without going through the header
+        std::vector<bool> in_loop(size(), false);
+        std::vector<int> stack;
+        for (auto predecessor: predecessor_edges[header]) {
+            if (dominates(header, predecessor)) {
+                stack.push_back(predecessor);
+            }
+        }
+        if (stack.empty()) {
+            continue;
+        }
+        in_loop[header] = true;
+        while (!stack.empty()) {
+            const int block = stack.back();
+            stack.pop_back();
+            if (in_loop[block] || !reachable(block)) {
+                continue;
+            }
+            in_loop[block] = true;
+            stack.insert(stack.end(), predecessor_edges[block].begin(), predecessor_edges[block].end());
+        }
+        Loop &loop = result.emplace_back(Loop{header, {}});
+        for (int block = 0; block < size(); block++) {
+            if (in_loop[block]) {
+                loop.blocks.push_back(block);
+            }
+        }
+    }
+    // A loop inside another has fewer blocks
+    std::stable_sort(result.begin(), result.end(), [](const Loop &left, const Loop &right) {
+        return left.blocks.size() < right.blocks.size();
+    });
+    return result;
+}
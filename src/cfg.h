@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#include "ir.h"
+
+// Blocks that can repeat, entered through the header, which dominates them all
+struct Loop {
+    int header;
+    std::vector<int> blocks; // Header included, in the order of the function
+};
+
+/**
+ * Control flow between the basic blocks of a function, numbered by their position in it. The first block is the entry.
+ * A block goes to the target of the jump or branch it ends with and, unless it ends with a jump, a return or a halt,
+ * falls through to the next one.
+ */
+class CFG {
+public:
+    explicit CFG(const ir::Function &function);
+
+    [[nodiscard]] int size() const { return static_cast<int>(successor_edges.size()); }
+    [[nodiscard]] const std::vector<int> &successors(int block) const { return successor_edges[block]; }
+    [[nodiscard]] const std::vector<int> &predecessors(int block) const { return predecessor_edges[block]; }
+
+    // Blocks reachable from the entry, each one before its successors except along the edges that close a loop
+    [[nodiscard]] const std::vector<int> &reverse_postorder() const { return order; }
+    [[nodiscard]] bool reachable(int block) const { return position[block] >= 0; }
+
+    // The last block before this one on every path from the entry, -1 for the entry and the unreachable blocks
+    [[nodiscard]] int immediate_dominator(int block) const { return block == 0 ? -1 : idom[block]; }
+    // Blocks this one is the immediate dominator of
+    [[nodiscard]] const std::vector<int> &dominated(int block) const { return dominator_children[block]; }
+    // Whether every path from the entry to a block goes through another one, a block dominating itself
+    [[nodiscard]] bool dominates(int dominator, int block) const;
+
+    /**
+     * Natural loops, found from the edges going back to a block dominating their source. Loops sharing a header are
+     * merged, and inner loops come before the loops containing them.
+     */
+    [[nodiscard]] std::vector<Loop> loops() const;
+
+private:
+    std::vector<std::vector<int>> successor_edges;
+    std::vector<std::vector<int>> predecessor_edges;
+    std::vector<int> order;
+    std::vector<int> position; // In order, -1 for the unreachable blocks
+    std::vector<int> idom;
+    std::vector<std::vector<int>> dominator_children;
+
+    void find_dominators();
+};
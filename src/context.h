@@ -0,0 +1,11 @@
+#pragma once
+
+#include "arena.h"
+
+/**
+ * State owned by one compilation and shared by all of its phases. Everything allocated in it, like the AST, stays valid
+ * until the context is destroyed.
+ */
+struct CompilationContext {
+    Arena arena;
+};
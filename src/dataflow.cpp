@@ -0,0 +1,443 @@
+#include "dataflow.h"
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+
+using ir::Opcode;
+
+namespace dataflow {
+    namespace {
+        std::vector<Counter> all_counters = {
+            {.name = "cfg"},
+            {.name = "liveness"},
+            {.name = "reaching definitions"},
+            {.name = "available expressions"},
+        };
+
+        std::vector<BitSet> sets(const CFG &cfg, std::size_t facts) {
+            return std::vector<BitSet>(cfg.size(), BitSet(facts));
+        }
+    }
+
+    Timer::Timer(std::string_view name, std::size_t blocks) :
+        counter(*std::find_if(all_counters.begin(), all_counters.end(),
+                              [&](const Counter &counter) { return counter.name == name; })),
+        start(std::chrono::steady_clock::now()) {
+        counter.runs++;
+        counter.largest = std::max(counter.largest, blocks);
+    }
+
+    Timer::~Timer() {
+        counter.time += std::chrono::steady_clock::now() - start;
+    }
+
+    void Timer::count(const Solution &solution) {
+        counter.evaluations += solution.evaluations;
+    }
+
+    BitSet::BitSet(std::size_t size, bool value) : bits(size), words((size + 63) / 64, value ? ~std::uint64_t{0} : 0) {
+        if (value && size % 64 != 0) {
+            words.back() &= (std::uint64_t{1} << (size % 64)) - 1;
+        }
+    }
+
+    BitSet &BitSet::operator|=(const BitSet &other) {
+        for (std::size_t word = 0; word < words.size(); word++) {
+            words[word] |= other.words[word];
+        }
+        return *this;
+    }
+
+    BitSet &BitSet::operator&=(const BitSet &other) {
+        for (std::size_t word = 0; word < words.size(); word++) {
+            words[word] &= other.words[word];
+        }
+        return *this;
+    }
+
+    BitSet &BitSet::operator-=(const BitSet &other) {
+        for (std::size_t word = 0; word < words.size(); word++) {
+            words[word] &= ~other.words[word];
+        }
+        return *this;
+    }
+
+    Solution solve(const CFG &cfg, const Problem &problem) {
+        const bool forward = problem.direction == Direction::FORWARD;
+        const bool all = problem.meet == Meet::INTERSECTION;
+        Solution solution;
+        auto &entering = forward ? solution.in : solution.out;
+        auto &leaving = forward ? solution.out : solution.in;
+        entering.assign(cfg.size(), BitSet(problem.facts));
+        // Sets a block computes start at the top of the lattice, a meet with a block not evaluated yet keeps the others
+        leaving.assign(cfg.size(), BitSet(problem.facts, all));
+
+        // Blocks are taken in reverse postorder for a forward problem and in postorder for a backward one, so most of
+        // them are evaluated after the blocks they depend on
+        std::vector<int> order = cfg.reverse_postorder();
+        if (!forward) {
+            std::reverse(order.begin(), order.end());
+        }
+        std::deque<int> worklist(order.begin(), order.end());
+        std::vector<bool> queued(cfg.size(), false);
+        for (auto block: order) {
+            queued[block] = true;
+        }
+
+        while (!worklist.empty()) {
+            const int block = worklist.front();
+            worklist.pop_front();
+            queued[block] = false;
+            solution.evaluations++;
+
+            // Meet of the sets along the incoming edges, the boundary counts as one more of them
+            BitSet facts(problem.facts);
+            bool first = true;
+            auto meet = [&](const BitSet &set) {
+                if (first) {
+                    facts = set;
+                } else if (all) {
+                    facts &= set;
+                } else {
+                    facts |= set;
+                }
+                first = false;
+            };
+            const auto &sources = forward ? cfg.predecessors(block) : cfg.successors(block);
+            if (forward ? block == 0 : sources.empty()) {
+                meet(problem.boundary);
+            }
+            for (auto source: sources) {
+                // Unreachable blocks are never evaluated, they would only weaken an intersection
+                if (cfg.reachable(source)) {
+                    meet(leaving[source]);
+                }
+            }
+            entering[block] = facts;
+
+            facts -= problem.kill[block];
+            facts |= problem.gen[block];
+            if (facts == leaving[block]) {
+                continue;
+            }
+            leaving[block] = std::move(facts);
+            for (auto target: forward ? cfg.successors(block) : cfg.predecessors(block)) {
+                if (cfg.reachable(target) && !queued[target]) {
+                    queued[target] = true;
+                    worklist.push_back(target);
+                }
+            }
+        }
+        return solution;
+    }
+
+    Locations::Locations(const ir::Function &function) :
+        registers(function.registers),
+        return_address_offset(function.return_address_offset),
+        return_value_offset(function.return_value_offset) {
+        slots = {function.return_address_offset, function.return_value_offset};
+        for (const auto &block: function.blocks) {
+            for (const auto &instruction: block.instructions) {
+                if (instruction.op == Opcode::LOAD || instruction.op == Opcode::STORE || instruction.op == Opcode::READ) {
+                    slots.push_back(instruction.imm);
+                }
+            }
+        }
+        std::sort(slots.begin(), slots.end(), std::greater<>());
+        slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+        for (std::size_t slot = 0; slot < slots.size(); slot++) {
+            slot_index[slots[slot]] = slot;
+        }
+    }
+
+    std::string Locations::name(std::size_t location) const {
+        if (is_slot(location)) {
+            return '[' + std::to_string(slots[location - registers]) + ']';
+        }
+        return 'v' + std::to_string(location);
+    }
+
+    void Locations::uses(const ir::Instruction &instruction, std::vector<std::size_t> &locations) const {
+        const auto &i = instruction;
+        locations.clear();
+        for (auto used: {i.lhs, i.rhs}) {
+            if (used != ir::no_reg) {
+                locations.push_back(reg(used));
+            }
+        }
+        for (auto arg: i.args) {
+            locations.push_back(reg(arg));
+        }
+        switch (i.op) {
+            case Opcode::LOAD:
+                locations.push_back(slot(i.imm));
+                break;
+            case Opcode::CALL:
+            case Opcode::WRITE:
+            case Opcode::READ:
+                // Slots are sorted from the top of the frame down, the ones of the callee frame come last
+                for (auto it = std::lower_bound(slots.begin(), slots.end(), i.frame, std::greater<>());
+                     it != slots.end(); ++it) {
+                    locations.push_back(registers + (it - slots.begin()));
+                }
+                break;
+            case Opcode::RETURN:
+                locations.push_back(slot(return_address_offset));
+                locations.push_back(slot(return_value_offset));
+                break;
+            default:
+                break;
+        }
+    }
+
+    void Locations::defs(const ir::Instruction &instruction, std::vector<std::size_t> &locations) const {
+        locations.clear();
+        if (instruction.dst != ir::no_reg) {
+            locations.push_back(reg(instruction.dst));
+        }
+        if (instruction.op == Opcode::STORE || instruction.op == Opcode::READ) {
+            locations.push_back(slot(instruction.imm));
+        }
+    }
+
+    Liveness liveness(const ir::Function &function, const CFG &cfg) {
+        Timer timer("liveness", cfg.size());
+        Locations locations(function);
+        Problem problem = {.direction = Direction::BACKWARD, .meet = Meet::UNION, .facts = locations.size(),
+                           .gen = sets(cfg, locations.size()), .kill = sets(cfg, locations.size()),
+                           .boundary = BitSet(locations.size())};
+        std::vector<std::size_t> uses;
+        std::vector<std::size_t> defs;
+        for (int block = 0; block < cfg.size(); block++) {
+            const auto &instructions = function.blocks[block].instructions;
+            // Walking the block backwards, a use is exposed unless a later instruction wrote the location before
+            for (auto it = instructions.rbegin(); it != instructions.rend(); ++it) {
+                locations.defs(*it, defs);
+                for (auto def: defs) {
+                    problem.kill[block].set(def);
+                    problem.gen[block].reset(def);
+                }
+                locations.uses(*it, uses);
+                for (auto use: uses) {
+                    problem.gen[block].set(use);
+                }
+            }
+        }
+        Liveness result = {std::move(locations), solve(cfg, problem)};
+        timer.count(result.solution);
+        return result;
+    }
+
+    std::vector<Interval> live_intervals(const ir::Function &function, const CFG &cfg) {
+        const auto live = liveness(function, cfg);
+        std::vector<Interval> intervals(function.registers);
+        auto cover = [&](ir::VReg reg, int position) {
+            auto &interval = intervals[reg];
+            if (interval.start < 0 || position < interval.start) {
+                interval.start = position;
+            }
+            interval.end = std::max(interval.end, position);
+        };
+        int position = 0;
+        for (int block = 0; block < cfg.size(); block++) {
+            const int first = position;
+            for (const auto &instruction: function.blocks[block].instructions) {
+                for (auto reg: {instruction.dst, instruction.lhs, instruction.rhs}) {
+                    if (reg != ir::no_reg) {
+                        cover(reg, position);
+                    }
+                }
+                for (auto arg: instruction.args) {
+                    cover(arg, position);
+                }
+                position++;
+            }
+            // An empty block is where the next one starts
+            const int last = std::max(first, position - 1);
+            for (ir::VReg reg = 0; reg < function.registers; reg++) {
+                if (live.solution.in[block].test(live.locations.reg(reg))) {
+                    cover(reg, first);
+                }
+                if (live.solution.out[block].test(live.locations.reg(reg))) {
+                    cover(reg, last);
+                }
+            }
+        }
+        return intervals;
+    }
+
+    ReachingDefinitions reaching_definitions(const ir::Function &function, const CFG &cfg) {
+        Timer timer("reaching definitions", cfg.size());
+        ReachingDefinitions result = {.locations = Locations(function)};
+        std::vector<std::size_t> defs;
+        std::vector<std::vector<std::size_t>> defining(result.locations.size()); // Definitions of each location
+        for (int block = 0; block < cfg.size(); block++) {
+            const auto &instructions = function.blocks[block].instructions;
+            for (int index = 0; index < static_cast<int>(instructions.size()); index++) {
+                result.locations.defs(instructions[index], defs);
+                for (auto def: defs) {
+                    defining[def].push_back(result.definitions.size());
+                    result.definitions.push_back({block, index, def});
+                }
+            }
+        }
+
+        const auto facts = result.definitions.size();
+        Problem problem = {.direction = Direction::FORWARD, .meet = Meet::UNION, .facts = facts,
+                           .gen = sets(cfg, facts), .kill = sets(cfg, facts), .boundary = BitSet(facts)};
+        for (std::size_t definition = 0; definition < facts; definition++) {
+            const auto &[block, index, location] = result.definitions[definition];
+            // Definitions are numbered in order, a later one of the same location in the block replaces this one
+            for (auto other: defining[location]) {
+                if (other != definition) {
+                    problem.kill[block].set(other);
+                    problem.gen[block].reset(other);
+                }
+            }
+            problem.gen[block].set(definition);
+        }
+        result.solution = solve(cfg, problem);
+        timer.count(result.solution);
+        return result;
+    }
+
+    std::optional<Expression> expression(const ir::Instruction &instruction) {
+        const auto &i = instruction;
+        if (i.op == Opcode::LOAD) {
+            return Expression{i.op, ir::no_reg, ir::no_reg, i.imm};
+        }
+        if (ir::is_binary(i.op)) {
+            return Expression{i.op, i.lhs, i.rhs, i.rhs == ir::no_reg ? i.imm : 0};
+        }
+        return std::nullopt;
+    }
+
+    std::ostream &operator<<(std::ostream &o, const Expression &expression) {
+        if (expression.op == Opcode::LOAD) {
+            return o << '[' << expression.imm << ']';
+        }
+        o << ir::to_string(expression.op) << " v" << expression.lhs << ", ";
+        if (expression.rhs == ir::no_reg) {
+            return o << expression.imm;
+        }
+        return o << 'v' << expression.rhs;
+    }
+
+    AvailableExpressions available_expressions(const ir::Function &function, const CFG &cfg) {
+        Timer timer("available expressions", cfg.size());
+        AvailableExpressions result;
+        const Locations locations(function);
+        std::vector<std::vector<std::size_t>> reading(locations.size()); // Expressions over each location
+        for (const auto &block: function.blocks) {
+            for (const auto &instruction: block.instructions) {
+                auto computed = expression(instruction);
+                if (!computed || std::find(result.expressions.begin(), result.expressions.end(), *computed) !=
+                                 result.expressions.end()) {
+                    continue;
+                }
+                if (computed->op == Opcode::LOAD) {
+                    reading[locations.slot(computed->imm)].push_back(result.expressions.size());
+                }
+                for (auto operand: {computed->lhs, computed->rhs}) {
+                    if (operand != ir::no_reg) {
+                        reading[locations.reg(operand)].push_back(result.expressions.size());
+                    }
+                }
+                result.expressions.push_back(*computed);
+            }
+        }
+
+        const auto facts = result.expressions.size();
+        Problem problem = {.direction = Direction::FORWARD, .meet = Meet::INTERSECTION, .facts = facts,
+                           .gen = sets(cfg, facts), .kill = sets(cfg, facts), .boundary = BitSet(facts)};
+        std::vector<std::size_t> defs;
+        for (int block = 0; block < cfg.size(); block++) {
+            for (const auto &instruction: function.blocks[block].instructions) {
+                if (auto computed = expression(instruction)) {
+                    const auto fact = std::find(result.expressions.begin(), result.expressions.end(), *computed) -
+                                      result.expressions.begin();
+                    problem.gen[block].set(fact);
+                }
+                // Writing an operand, after computing the expression too, makes its value stale
+                locations.defs(instruction, defs);
+                for (auto def: defs) {
+                    for (auto fact: reading[def]) {
+                        problem.gen[block].reset(fact);
+                        problem.kill[block].set(fact);
+                    }
+                }
+            }
+        }
+        result.solution = solve(cfg, problem);
+        timer.count(result.solution);
+        return result;
+    }
+
+    const std::vector<Counter> &counters() {
+        return all_counters;
+    }
+
+    void print_counters(std::ostream &o) {
+        o << std::left << std::setw(24) << "analysis" << std::setw(8) << "runs" << std::setw(14) << "evaluations"
+          << std::setw(16) << "largest blocks" << "time (us)" << '\n';
+        for (const auto &counter: all_counters) {
+            o << std::left << std::setw(24) << counter.name << std::setw(8) << counter.runs << std::setw(14)
+              << counter.evaluations << std::setw(16) << counter.largest
+              << std::chrono::duration_cast<std::chrono::microseconds>(counter.time).count() << '\n';
+        }
+    }
+
+    void print(std::ostream &o, const ir::Module &module) {
+        auto print_set = [&](std::string_view title, const BitSet &set, auto &&name) {
+            o << '\t' << title << ':';
+            for (std::size_t fact = 0; fact < set.size(); fact++) {
+                if (set.test(fact)) {
+                    o << ' ' << name(fact);
+                }
+            }
+            o << '\n';
+        };
+
+        for (const auto &function: module.functions) {
+            const CFG cfg(function);
+            const auto live = liveness(function, cfg);
+            const auto reaching = reaching_definitions(function, cfg);
+            const auto available = available_expressions(function, cfg);
+            auto location_name = [&](std::size_t location) { return live.locations.name(location); };
+            auto definition_name = [&](std::size_t fact) {
+                const auto &definition = reaching.definitions[fact];
+                return reaching.locations.name(definition.location) + '@' + std::to_string(definition.block) + '.' +
+                       std::to_string(definition.index);
+            };
+            auto expression_name = [&](std::size_t fact) {
+                std::ostringstream name;
+                name << '(' << available.expressions[fact] << ')';
+                return name.str();
+            };
+
+            o << "function " << function.name << " (" << function.label << ")\n";
+            for (int block = 0; block < cfg.size(); block++) {
+                o << "block " << block;
+                if (!function.blocks[block].label.empty()) {
+                    o << ' ' << function.blocks[block].label;
+                }
+                if (!cfg.reachable(block)) {
+                    o << " unreachable";
+                }
+                o << " ->";
+                for (auto successor: cfg.successors(block)) {
+                    o << ' ' << successor;
+                }
+                o << '\n';
+                print_set("live in", live.solution.in[block], location_name);
+                print_set("live out", live.solution.out[block], location_name);
+                print_set("reaching in", reaching.solution.in[block], definition_name);
+                print_set("available in", available.solution.in[block], expression_name);
+            }
+            o << '\n';
+        }
+    }
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "cfg.h"
+#include "ir.h"
+
+/**
+ * Iterative dataflow analysis over the CFG of a function. A problem gives, for every block, the facts it generates and
+ * the ones it kills, the solver propagates them along the edges with a worklist until nothing changes.
+ *
+ * Liveness, reaching definitions and available expressions are built on it. Their facts are about the virtual
+ * registers and the frame slots reached through LOAD and STORE, the only places three-address code keeps values in.
+ */
+namespace dataflow {
+    // A set of facts numbered from 0, one bit each
+    class BitSet {
+    public:
+        BitSet() = default;
+        explicit BitSet(std::size_t size, bool value = false);
+
+        [[nodiscard]] std::size_t size() const { return bits; }
+        [[nodiscard]] bool test(std::size_t fact) const { return words[fact / 64] >> (fact % 64) & 1; }
+        void set(std::size_t fact) { words[fact / 64] |= std::uint64_t{1} << (fact % 64); }
+        void reset(std::size_t fact) { words[fact / 64] &= ~(std::uint64_t{1} << (fact % 64)); }
+
+        BitSet &operator|=(const BitSet &other);
+        BitSet &operator&=(const BitSet &other);
+        BitSet &operator-=(const BitSet &other);
+        bool operator==(const BitSet &other) const = default;
+
+    private:
+        std::size_t bits = 0;
+        std::vector<std::uint64_t> words;
+    };
+
+    enum class Direction {
+        FORWARD,  // Facts flow from a block to its successors, in is the meet of the outs of the predecessors
+        BACKWARD, // Facts flow from a block to its predecessors, out is the meet of the ins of the successors
+    };
+
+    enum class Meet {
+        UNION,        // A fact holds when it holds along some path
+        INTERSECTION, // A fact holds when it holds along every path
+    };
+
+    // Facts leaving a block are gen | (facts entering it - kill), in the direction of the problem
+    struct Problem {
+        Direction direction;
+        Meet meet;
+        std::size_t facts;
+        std::vector<BitSet> gen; // By block
+        std::vector<BitSet> kill;
+        BitSet boundary; // Facts entering the entry block of a forward problem, or leaving the exits of a backward one
+    };
+
+    struct Solution {
+        std::vector<BitSet> in; // Facts holding at the start of each block
+        std::vector<BitSet> out; // Facts holding at the end of each block
+        int evaluations = 0; // Times a block was evaluated before the sets stopped changing
+    };
+
+    Solution solve(const CFG &cfg, const Problem &problem);
+
+    /**
+     * The virtual registers and frame slots of a function numbered as facts, registers first. Slots are the offsets
+     * the function loads, stores or reads to, along with its return value and return address.
+     */
+    class Locations {
+    public:
+        explicit Locations(const ir::Function &function);
+
+        [[nodiscard]] std::size_t size() const { return registers + slots.size(); }
+        [[nodiscard]] std::size_t reg(ir::VReg reg) const { return reg; }
+        [[nodiscard]] std::size_t slot(int offset) const { return registers + slot_index.at(offset); }
+        [[nodiscard]] bool is_slot(std::size_t location) const { return location >= registers; }
+        [[nodiscard]] std::string name(std::size_t location) const;
+
+        /**
+         * Locations an instruction reads. A call reads the arguments copied to the frame of its callee and the library
+         * routines their own, so those read every slot in or below the frame they are given.
+         */
+        void uses(const ir::Instruction &instruction, std::vector<std::size_t> &locations) const;
+        // Locations an instruction writes
+        void defs(const ir::Instruction &instruction, std::vector<std::size_t> &locations) const;
+
+    private:
+        std::size_t registers;
+        std::vector<int> slots; // From the top of the frame down
+        std::unordered_map<int, std::size_t> slot_index;
+        int return_address_offset;
+        int return_value_offset;
+    };
+
+    // A location is live where its value may still be read
+    struct Liveness {
+        Locations locations;
+        Solution solution;
+    };
+
+    Liveness liveness(const ir::Function &function, const CFG &cfg);
+
+    // Positions of the instructions of a function, numbered across its blocks in order, where a register holds its value
+    struct Interval {
+        int start = -1; // -1 for a register that is never defined or read
+        int end = -1;
+    };
+
+    /**
+     * The smallest interval of each virtual register covering its definition, its uses and every block it is live
+     * across. A value live around a loop keeps its register from the first block of the loop to the last.
+     */
+    std::vector<Interval> live_intervals(const ir::Function &function, const CFG &cfg);
+
+    struct Definition {
+        int block;
+        int index; // In the instructions of the block
+        std::size_t location;
+    };
+
+    // A definition reaches a point when some path from it to there does not write its location again
+    struct ReachingDefinitions {
+        Locations locations;
+        std::vector<Definition> definitions; // The facts
+        Solution solution;
+    };
+
+    ReachingDefinitions reaching_definitions(const ir::Function &function, const CFG &cfg);
+
+    // A binary operation, or the load of a slot
+    struct Expression {
+        ir::Opcode op;
+        ir::VReg lhs;
+        ir::VReg rhs;
+        int imm;
+
+        bool operator==(const Expression &other) const = default;
+    };
+
+    std::optional<Expression> expression(const ir::Instruction &instruction);
+
+    std::ostream &operator<<(std::ostream &o, const Expression &expression);
+
+    // An expression is available where every path to there computed it and did not write its operands since
+    struct AvailableExpressions {
+        std::vector<Expression> expressions; // The facts
+        Solution solution;
+    };
+
+    AvailableExpressions available_expressions(const ir::Function &function, const CFG &cfg);
+
+    // Cost of one kind of analysis, summed over the functions it ran on
+    struct Counter {
+        std::string_view name;
+        int runs = 0;
+        long long evaluations = 0; // Blocks evaluated by the solver
+        std::size_t largest = 0; // Blocks in the largest function
+        std::chrono::nanoseconds time{};
+    };
+
+    const std::vector<Counter> &counters();
+
+    // Adds the time from its construction to its destruction to the counter of an analysis, or of building a CFG
+    class Timer {
+    public:
+        Timer(std::string_view name, std::size_t blocks);
+        ~Timer();
+
+        void count(const Solution &solution);
+
+    private:
+        Counter &counter;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    void print_counters(std::ostream &o);
+
+    // Writes the CFG of every function with the facts of each analysis at the start and end of every block
+    void print(std::ostream &o, const ir::Module &module);
+}
@@ -0,0 +1,97 @@
+#include "deadcode.h"
+
+#include <algorithm>
+
+#include "cfg.h"
+#include "dataflow.h"
+#include "moonemitter.h"
+
+using ir::Opcode;
+
+namespace {
+    // Written as 4 bytes each
+    int bytes(const ir::Instruction &instruction) {
+        return MoonEmitter::words(instruction) * 4;
+    }
+}
+
+int DeadCodeElimination::run(ir::Module &module, AnalysisCache &analyses) {
+    int removed = 0;
+    for (auto &function: module.functions) {
+        Report report = {.function = function.name};
+        remove_unreachable(function, analyses, report);
+        while (remove_dead(function, analyses, report)) {
+        }
+        removed += report.blocks + report.instructions;
+        reports.push_back(report);
+    }
+    return removed;
+}
+
+void DeadCodeElimination::remove_unreachable(ir::Function &function, AnalysisCache &analyses, Report &report) {
+    const auto &cfg = analyses.cfg(function);
+    if (static_cast<int>(cfg.reverse_postorder().size()) == cfg.size()) {
+        return;
+    }
+    std::vector<ir::BasicBlock> blocks;
+    for (int block = 0; block < cfg.size(); block++) {
+        if (cfg.reachable(block)) {
+            blocks.push_back(std::move(function.blocks[block]));
+            continue;
+        }
+        report.blocks++;
+        for (const auto &instruction: function.blocks[block].instructions) {
+            report.bytes += bytes(instruction);
+        }
+    }
+    function.blocks = std::move(blocks);
+    analyses.invalidate(function);
+}
+
+bool DeadCodeElimination::remove_dead(ir::Function &function, AnalysisCache &analyses, Report &report) {
+    const auto &cfg = analyses.cfg(function);
+    const auto &live = analyses.liveness(function);
+    const auto &locations = live.locations;
+    std::vector<std::size_t> uses;
+    std::vector<std::size_t> defs;
+    bool changed = false;
+    for (int block = 0; block < cfg.size(); block++) {
+        auto &instructions = function.blocks[block].instructions;
+        std::vector<bool> dead(instructions.size(), false);
+        auto facts = live.solution.out[block];
+        for (auto index = instructions.size(); index-- > 0;) {
+            const auto &i = instructions[index];
+            locations.defs(i, defs);
+            const bool removable = i.op == Opcode::CONST || i.op == Opcode::LOAD || i.op == Opcode::STORE ||
+                                   (ir::is_binary(i.op) && i.op != Opcode::DIV);
+            if (removable && std::none_of(defs.begin(), defs.end(), [&](auto def) { return facts.test(def); })) {
+                dead[index] = true;
+                report.instructions++;
+                report.stores += i.op == Opcode::STORE;
+                report.bytes += bytes(i);
+                changed = true;
+                continue;
+            }
+            for (auto def: defs) {
+                facts.reset(def);
+            }
+            locations.uses(i, uses);
+            for (auto use: uses) {
+                facts.set(use);
+            }
+        }
+        std::size_t index = 0;
+        std::erase_if(instructions, [&](const ir::Instruction &) { return dead[index++]; });
+    }
+    if (changed) {
+        analyses.invalidate(function, AnalysisCache::Preserved::CFG);
+    }
+    return changed;
+}
+
+void DeadCodeElimination::print_report(std::ostream &o) const {
+    for (const auto &report: reports) {
+        o << report.function << ": " << report.bytes << " bytes removed, " << report.blocks << " unreachable blocks, "
+          << report.instructions << " dead instructions of which " << report.stores << " stores\n";
+    }
+}
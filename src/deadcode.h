@@ -0,0 +1,40 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+#include "ir.h"
+#include "passmanager.h"
+
+/**
+ * Removes the blocks no path from the entry reaches, then the instructions whose result is never read: computations
+ * into a dead register and stores to a slot that is written again or never loaded before the function returns. Both
+ * are found with liveness, which is computed again after every round since a removed store can leave the value it
+ * stored dead in turn.
+ *
+ * Calls, library routines and divisions, which may stop the program, are always kept.
+ */
+class DeadCodeElimination : public Pass {
+public:
+    [[nodiscard]] std::string_view name() const override { return "dead-code-elimination"; }
+    // Blocks and instructions removed
+    int run(ir::Module &module, AnalysisCache &analyses) override;
+
+    // Instructions and bytes of code removed from each function
+    void print_report(std::ostream &o) const override;
+
+private:
+    struct Report {
+        Name function;
+        int blocks = 0; // Unreachable
+        int instructions = 0; // Dead, the ones of the unreachable blocks aside
+        int stores = 0; // Of the dead instructions
+        int bytes = 0; // Of MOON code, before the peephole optimizer
+    };
+
+    std::vector<Report> reports;
+
+    static void remove_unreachable(ir::Function &function, AnalysisCache &analyses, Report &report);
+    // One round over the function, returns whether an instruction was removed
+    static bool remove_dead(ir::Function &function, AnalysisCache &analyses, Report &report);
+};
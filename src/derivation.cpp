@@ -0,0 +1,162 @@
+#include "derivation.h"
+
+#include <cassert>
+#include <limits>
+
+void Derivation::Form::replace(const std::string_view *begin, const std::string_view *end) {
+    if (!pending.empty()) {
+        pending.pop_back();
+    }
+    while (end != begin) {
+        pending.push_back(*--end);
+    }
+}
+
+void Derivation::Form::accept(std::string_view token) {
+    if (!pending.empty()) {
+        pending.pop_back();
+    }
+    accepted.push_back(token);
+}
+
+void Derivation::Form::epsilon() {
+    if (!pending.empty()) {
+        pending.pop_back();
+    }
+}
+
+void Derivation::Form::print(std::ostream &o, int line) const {
+    o << line << ": ";
+    for (const auto &value: accepted) {
+        o << value << ' ';
+    }
+    for (auto it = pending.rbegin(); it != pending.rend(); ++it) {
+        o << *it << ' ';
+    }
+    o << '\n';
+}
+
+void Derivation::apply_production(std::initializer_list<std::string_view> production, int line) {
+    if (mode != DerivationMode::FULL) {
+        steps.push_back({StepKind::PRODUCTION, intern(production), line});
+        return;
+    }
+    form.replace(production.begin(), production.end());
+    form.print(output, line);
+}
+
+void Derivation::apply_token(std::string_view token, int line) {
+    if (mode != DerivationMode::FULL) {
+        steps.push_back({StepKind::TOKEN, 0, line});
+        tokens.push_back(token);
+        return;
+    }
+    form.accept(token);
+    form.print(output, line);
+}
+
+void Derivation::apply_epsilon(int line) {
+    if (mode != DerivationMode::FULL) {
+        steps.push_back({StepKind::EPSILON, 0, line});
+        return;
+    }
+    form.epsilon();
+}
+
+void Derivation::apply_print(int line) {
+    if (mode != DerivationMode::FULL) {
+        steps.push_back({StepKind::PRINT, 0, line});
+        return;
+    }
+    form.print(output, line);
+}
+
+std::uint16_t Derivation::intern(std::initializer_list<std::string_view> production) {
+    assert(production.size() != 0);
+    auto &candidates = productions_by_head[*production.begin()];
+    for (std::uint16_t id: candidates) {
+        const auto &known = productions[id];
+        if (known.size() == production.size() && std::equal(known.begin(), known.end(), production.begin())) {
+            return id;
+        }
+    }
+    assert(productions.size() < std::numeric_limits<std::uint16_t>::max());
+    auto id = static_cast<std::uint16_t>(productions.size());
+    productions.emplace_back(production);
+    candidates.push_back(id);
+    return id;
+}
+
+void Derivation::finish() {
+    if (mode == DerivationMode::EXPANDED) {
+        expand(output);
+    }
+    if (mode != DerivationMode::COMPACT) {
+        output.flush();
+        return;
+    }
+
+    // Only the pending symbols are needed to know which nonterminal each production expands
+    std::vector<std::string_view> pending;
+    for (const Step &step: steps) {
+        std::string_view head = pending.empty() ? std::string_view() : pending.back();
+        switch (step.kind) {
+            case StepKind::PRODUCTION: {
+                const auto &production = productions[step.production];
+                // The start symbol derives from nothing, it is written alone like the first form of FULL
+                output << step.line << ':';
+                if (!head.empty()) {
+                    output << ' ' << head << " ->";
+                }
+                for (const auto &symbol: production) {
+                    output << ' ' << symbol;
+                }
+                output << '\n';
+                if (!pending.empty()) {
+                    pending.pop_back();
+                }
+                pending.insert(pending.end(), production.rbegin(), production.rend());
+                break;
+            }
+            case StepKind::EPSILON:
+                if (!pending.empty()) {
+                    output << step.line << ": " << head << " -> EPSILON\n";
+                    pending.pop_back();
+                }
+                break;
+            case StepKind::TOKEN:
+                if (!pending.empty()) {
+                    pending.pop_back();
+                }
+                break;
+            case StepKind::PRINT:
+                break;
+        }
+    }
+    output.flush();
+}
+
+void Derivation::expand(std::ostream &o) const {
+    Form replay;
+    auto token = tokens.begin();
+    for (const Step &step: steps) {
+        switch (step.kind) {
+            case StepKind::PRODUCTION: {
+                const auto &production = productions[step.production];
+                replay.replace(production.data(), production.data() + production.size());
+                replay.print(o, step.line);
+                break;
+            }
+            case StepKind::TOKEN:
+                replay.accept(*token++);
+                replay.print(o, step.line);
+                break;
+            case StepKind::EPSILON:
+                replay.epsilon();
+                break;
+            case StepKind::PRINT:
+                replay.print(o, step.line);
+                break;
+        }
+    }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+enum class DerivationMode {
+    OFF,     // No tracking at all
+    COMPACT, // Record production ids, write one line per production when parsing ends
+    EXPANDED, // Record production ids, write the sentential forms FULL would have from the record when parsing ends
+    FULL,    // Write the whole sentential form after every production and token
+};
+
+/**
+ * Leftmost derivation of the parse. The sentential form is kept as the accepted terminals followed by a stack of the
+ * symbols still to be derived, so every step is O(size of the production) instead of shifting the whole form.
+ *
+ * All views must outlive the derivation: productions are string literals, tokens point into the source buffer.
+ */
+class Derivation {
+public:
+    Derivation(DerivationMode mode, std::ostream &output) : mode(mode), output(output) {}
+
+    /**
+     * Replaces the leftmost symbol still to be derived by a production
+     * @param production right hand side
+     * @param line current line, used when printing
+     */
+    void insert(std::initializer_list<std::string_view> production, int line) {
+        if (mode != DerivationMode::OFF) {
+            apply_production(production, line);
+        }
+    }
+
+    // Matches a terminal against the leftmost symbol
+    void accept(std::string_view token, int line) {
+        if (mode != DerivationMode::OFF) {
+            apply_token(token, line);
+        }
+    }
+
+    // Derives the leftmost symbol to epsilon
+    void epsilon(int line) {
+        if (mode != DerivationMode::OFF) {
+            apply_epsilon(line);
+        }
+    }
+
+    // Prints the current sentential form
+    void print(int line) {
+        if (mode != DerivationMode::OFF) {
+            apply_print(line);
+        }
+    }
+
+    // Writes the recorded productions once parsing is done, or their sentential forms when EXPANDED
+    void finish();
+
+    [[nodiscard]] DerivationMode get_mode() const { return mode; }
+
+private:
+    enum class StepKind : std::uint16_t { PRODUCTION, TOKEN, EPSILON, PRINT };
+
+    struct Step {
+        StepKind kind;
+        std::uint16_t production = 0; // Index in productions for PRODUCTION steps
+        int line = 0;
+    };
+
+    // Sentential form: accepted terminals, then the pending symbols with the leftmost one at the back
+    struct Form {
+        std::vector<std::string_view> accepted;
+        std::vector<std::string_view> pending;
+
+        void replace(const std::string_view *begin, const std::string_view *end);
+        void accept(std::string_view token);
+        void epsilon();
+        void print(std::ostream &o, int line) const;
+    };
+
+    DerivationMode mode;
+    std::ostream &output;
+    Form form;
+
+    // COMPACT record
+    std::vector<Step> steps;
+    std::vector<std::string_view> tokens;
+    std::vector<std::vector<std::string_view>> productions;
+    std::unordered_map<std::string_view, std::vector<std::uint16_t>> productions_by_head;
+
+    void apply_production(std::initializer_list<std::string_view> production, int line);
+    void apply_token(std::string_view token, int line);
+    void apply_epsilon(int line);
+    void apply_print(int line);
+
+    std::uint16_t intern(std::initializer_list<std::string_view> production);
+
+    // Writes the sentential forms of the record exactly as FULL would have printed them
+    void expand(std::ostream &o) const;
+};
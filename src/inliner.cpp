@@ -0,0 +1,183 @@
+#include "inliner.h"
+
+#include <functional>
+
+using ir::Opcode;
+
+int Inliner::run(ir::Module &module, AnalysisCache &analyses) {
+    functions.clear();
+    for (auto &function: module.functions) {
+        functions[function.label] = &function;
+    }
+    find_recursive(module);
+
+    // Callees before callers
+    std::vector<ir::Function *> order;
+    std::unordered_set<const ir::Function *> visited;
+    std::function<void(ir::Function &)> visit = [&](ir::Function &function) {
+        if (!visited.insert(&function).second) {
+            return;
+        }
+        for (const auto &block: function.blocks) {
+            for (const auto &instruction: block.instructions) {
+                if (instruction.op != Opcode::CALL) {
+                    continue;
+                }
+                if (auto callee = functions.find(instruction.label); callee != functions.end()) {
+                    visit(*callee->second);
+                }
+            }
+        }
+        order.push_back(&function);
+    };
+    for (auto &function: module.functions) {
+        visit(function);
+    }
+    int inlined = 0;
+    for (auto function: order) {
+        if (const int calls = inline_calls(*function); calls > 0) {
+            analyses.invalidate(*function);
+            inlined += calls;
+        }
+    }
+    return inlined;
+}
+
+void Inliner::find_recursive(const ir::Module &module) {
+    recursive.clear();
+    for (const auto &function: module.functions) {
+        // Depth-first search of the functions reachable from this one
+        std::unordered_set<const ir::Function *> reached;
+        std::vector<const ir::Function *> stack = {&function};
+        while (!stack.empty() && !recursive.contains(&function)) {
+            auto current = stack.back();
+            stack.pop_back();
+            for (const auto &block: current->blocks) {
+                for (const auto &instruction: block.instructions) {
+                    auto callee = instruction.op == Opcode::CALL ? functions.find(instruction.label) : functions.end();
+                    if (callee == functions.end()) {
+                        continue;
+                    }
+                    if (callee->second == &function) {
+                        recursive.insert(&function);
+                    }
+                    if (reached.insert(callee->second).second) {
+                        stack.push_back(callee->second);
+                    }
+                }
+            }
+        }
+    }
+}
+
+int Inliner::size(const ir::Function &function) {
+    int size = 0;
+    for (const auto &block: function.blocks) {
+        for (const auto &instruction: block.instructions) {
+            size += instruction.op != Opcode::COMMENT;
+        }
+    }
+    return size;
+}
+
+int Inliner::inline_calls(ir::Function &function) {
+    std::vector<ir::BasicBlock> blocks;
+    int inlined = 0;
+    for (auto &block: function.blocks) {
+        blocks.push_back({.label = std::move(block.label)});
+        for (auto &instruction: block.instructions) {
+            auto callee = instruction.op == Opcode::CALL ? functions.find(instruction.label) : functions.end();
+            if (callee == functions.end()) {
+                blocks.back().instructions.push_back(std::move(instruction));
+                continue;
+            }
+            const int callee_size = size(*callee->second);
+            if (recursive.contains(callee->second)) {
+                report.push_back({function.name, callee->second->name, false, "recursive"});
+            } else if (callee_size > threshold) {
+                report.push_back({function.name, callee->second->name, false,
+                                  std::to_string(callee_size) + " instructions, threshold " + std::to_string(threshold)});
+            } else {
+                report.push_back({function.name, callee->second->name, true,
+                                  std::to_string(callee_size) + " instructions"});
+                inline_call(function, instruction, *callee->second, blocks);
+                inlined++;
+                continue;
+            }
+            blocks.back().instructions.push_back(std::move(instruction));
+        }
+    }
+    function.blocks = std::move(blocks);
+    return inlined;
+}
+
+void Inliner::inline_call(ir::Function &caller, const ir::Instruction &call, const ir::Function &callee,
+                          std::vector<ir::BasicBlock> &blocks) {
+    const int frame = call.frame; // Offset of the callee frame in the caller frame
+    const int base = caller.registers;
+    caller.registers += callee.registers;
+    const std::string suffix = "_" + std::to_string(inline_num++);
+    const std::string after_label = "inline" + suffix;
+    auto reg = [&](ir::VReg reg) { return reg == ir::no_reg ? reg : reg + base; };
+
+    blocks.back().instructions.push_back({.op = Opcode::COMMENT, .comment = "Inlined call to " + callee.name.str()});
+    // Arguments passed in registers go to the slots the callee would have stored them to
+    for (std::size_t arg = 0; arg < call.args.size(); arg++) {
+        blocks.back().instructions.push_back({.op = Opcode::STORE, .lhs = call.args[arg],
+                                              .imm = callee.register_params[arg] + frame});
+    }
+
+    for (const auto &block: callee.blocks) {
+        blocks.push_back({.label = block.label.empty() ? "" : block.label + suffix});
+        for (auto instruction: block.instructions) {
+            instruction.dst = reg(instruction.dst);
+            instruction.lhs = reg(instruction.lhs);
+            instruction.rhs = reg(instruction.rhs);
+            for (auto &arg: instruction.args) {
+                arg = reg(arg);
+            }
+            switch (instruction.op) {
+                case Opcode::LOAD:
+                case Opcode::STORE:
+                    instruction.imm += frame;
+                    break;
+                case Opcode::READ:
+                    instruction.imm += frame;
+                    instruction.frame += frame;
+                    break;
+                case Opcode::CALL:
+                case Opcode::WRITE:
+                    instruction.frame += frame;
+                    break;
+                case Opcode::JUMP:
+                case Opcode::BRANCH_ZERO:
+                case Opcode::BRANCH_NONZERO:
+                    instruction.label += suffix;
+                    break;
+                case Opcode::RETURN:
+                    // The value returned in a register is left in the return slot as well
+                    if (instruction.lhs != ir::no_reg) {
+                        blocks.back().instructions.push_back({.op = Opcode::STORE, .lhs = instruction.lhs,
+                                                              .imm = call.imm + frame});
+                    }
+                    instruction = {.op = Opcode::JUMP, .label = after_label};
+                    break;
+                default:
+                    break;
+            }
+            blocks.back().instructions.push_back(std::move(instruction));
+        }
+    }
+
+    blocks.push_back({.label = after_label});
+    if (call.dst != ir::no_reg) {
+        blocks.back().instructions.push_back({.op = Opcode::LOAD, .dst = call.dst, .imm = call.imm + frame});
+    }
+}
+
+void Inliner::print_report(std::ostream &o) const {
+    for (const auto &site: report) {
+        o << site.caller << ": " << (site.inlined ? "inlined " : "kept call to ") << site.callee << " ("
+          << site.reason << ")\n";
+    }
+}
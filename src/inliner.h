@@ -0,0 +1,52 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ir.h"
+#include "passmanager.h"
+
+/**
+ * Replaces calls to small functions by a copy of their three-address code. The copy runs in the frame the call would
+ * have given the callee, so its slots and the argument slots keep their offsets relative to that frame, and its returns
+ * leave the value in the return slot and jump to the code after the call.
+ *
+ * Callees are handled before their callers, a function is measured with its own small callees already inlined.
+ * Recursive functions are never inlined.
+ */
+class Inliner : public Pass {
+public:
+    // Callees with more instructions than threshold, comments aside, are still called
+    explicit Inliner(int threshold) : threshold(threshold) {}
+
+    [[nodiscard]] std::string_view name() const override { return "inline"; }
+    // Calls inlined
+    int run(ir::Module &module, AnalysisCache &analyses) override;
+
+    // One line per call site, whether it was inlined and why not
+    void print_report(std::ostream &o) const override;
+
+private:
+    struct CallSite {
+        Name caller;
+        Name callee;
+        bool inlined;
+        std::string reason;
+    };
+
+    int threshold;
+    int inline_num = 0;
+    std::vector<CallSite> report;
+    std::unordered_map<std::string, ir::Function *> functions; // By label
+    std::unordered_set<const ir::Function *> recursive;
+
+    void find_recursive(const ir::Module &module);
+    int inline_calls(ir::Function &function);
+    void inline_call(ir::Function &caller, const ir::Instruction &call, const ir::Function &callee,
+                     std::vector<ir::BasicBlock> &blocks);
+
+    static int size(const ir::Function &function);
+};
@@ -0,0 +1,116 @@
+#include "ir.h"
+
+namespace ir {
+    std::string_view to_string(Opcode op) {
+        switch (op) {
+            case Opcode::COMMENT: return "comment";
+            case Opcode::CONST: return "const";
+            case Opcode::LOAD: return "load";
+            case Opcode::STORE: return "store";
+            case Opcode::ADD: return "add";
+            case Opcode::SUB: return "sub";
+            case Opcode::MUL: return "mul";
+            case Opcode::DIV: return "div";
+            case Opcode::CEQ: return "ceq";
+            case Opcode::CNE: return "cne";
+            case Opcode::CLT: return "clt";
+            case Opcode::CGT: return "cgt";
+            case Opcode::CLE: return "cle";
+            case Opcode::CGE: return "cge";
+            case Opcode::CALL: return "call";
+            case Opcode::WRITE: return "write";
+            case Opcode::READ: return "read";
+            case Opcode::JUMP: return "jump";
+            case Opcode::BRANCH_ZERO: return "bz";
+            case Opcode::BRANCH_NONZERO: return "bnz";
+            case Opcode::RETURN: return "return";
+            case Opcode::HALT: return "halt";
+        }
+        return "";
+    }
+
+    bool is_binary(Opcode op) {
+        return op >= Opcode::ADD && op <= Opcode::CGE;
+    }
+
+    bool is_terminator(Opcode op) {
+        return op == Opcode::JUMP || op == Opcode::BRANCH_ZERO || op == Opcode::BRANCH_NONZERO || op == Opcode::RETURN ||
+               op == Opcode::HALT;
+    }
+
+    namespace {
+        struct Reg {
+            VReg reg;
+        };
+
+        std::ostream &operator<<(std::ostream &o, Reg reg) {
+            return o << 'v' << reg.reg;
+        }
+    }
+
+    std::ostream &operator<<(std::ostream &o, const Instruction &instruction) {
+        const auto &i = instruction;
+        switch (i.op) {
+            case Opcode::COMMENT:
+                return o << "% " << i.comment;
+            case Opcode::CONST:
+                return o << Reg{i.dst} << " = " << i.imm;
+            case Opcode::LOAD:
+                return o << Reg{i.dst} << " = [" << i.imm << ']';
+            case Opcode::STORE:
+                return o << '[' << i.imm << "] = " << Reg{i.lhs};
+            case Opcode::CALL:
+                if (i.dst != no_reg) {
+                    o << Reg{i.dst} << " = ";
+                }
+                o << "call " << i.label << '(';
+                for (std::size_t arg = 0; arg < i.args.size(); arg++) {
+                    o << (arg == 0 ? "" : ", ") << Reg{i.args[arg]};
+                }
+                return o << ") frame " << i.frame << " return [" << i.imm << ']';
+            case Opcode::WRITE:
+                return o << "write " << Reg{i.lhs} << " frame " << i.frame;
+            case Opcode::READ:
+                return o << '[' << i.imm << "] = read frame " << i.frame << " scratch " << Reg{i.dst};
+            case Opcode::JUMP:
+                return o << "jump " << i.label;
+            case Opcode::BRANCH_ZERO:
+            case Opcode::BRANCH_NONZERO:
+                return o << to_string(i.op) << ' ' << Reg{i.lhs} << ", " << i.label;
+            case Opcode::RETURN:
+                if (i.lhs != no_reg) {
+                    return o << "return " << Reg{i.lhs} << " to [" << i.imm << ']';
+                }
+                return o << "return [" << i.imm << ']';
+            case Opcode::HALT:
+                return o << "halt";
+            default:
+                o << Reg{i.dst} << " = " << to_string(i.op) << ' ' << Reg{i.lhs} << ", ";
+                if (i.rhs == no_reg) {
+                    return o << i.imm;
+                }
+                return o << Reg{i.rhs};
+        }
+    }
+
+    std::ostream &operator<<(std::ostream &o, const Module &module) {
+        for (const auto &function: module.functions) {
+            o << "function " << function.name << " (" << function.label << "), " << function.registers
+              << " registers, return address [" << function.return_address_offset << "]";
+            for (std::size_t param = 0; param < function.register_params.size(); param++) {
+                o << ", r" << param + 1 << " to [" << function.register_params[param] << ']';
+            }
+            o << '\n';
+            for (const auto &block: function.blocks) {
+                if (!block.label.empty()) {
+                    o << block.label << ":\n";
+                }
+                for (const auto &instruction: block.instructions) {
+                    o << '\t' << instruction << '\n';
+                }
+            }
+            o << '\n';
+        }
+        return o;
+    }
+}
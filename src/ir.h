@@ -0,0 +1,92 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "name.h"
+
+/**
+ * Three-address code between the annotated AST and the MOON assembly. Values live in an unbounded set of virtual
+ * registers, locals and temporaries stay in their frame slots and are reached through LOAD and STORE with the offsets
+ * computed by MemSizeVisitor.
+ */
+namespace ir {
+    using VReg = int;
+    constexpr VReg no_reg = -1;
+
+    // Where a call passes its arguments and gets its return value back
+    enum class CallingConvention {
+        MEMORY,    // Arguments in the parameter slots of the callee frame, the return value in its return slot
+        REGISTERS, // The first register_arguments int parameters in r1 and up, the return value in r13 like lib.m
+    };
+    constexpr int register_arguments = 4;
+
+    enum class Opcode {
+        COMMENT,     // % comment
+        CONST,       // dst = imm
+        LOAD,        // dst = frame[imm]
+        STORE,       // frame[imm] = lhs
+        ADD, SUB, MUL, DIV,          // dst = lhs op rhs, or lhs op imm when rhs is no_reg
+        CEQ, CNE, CLT, CGT, CLE, CGE,
+        CALL,        // dst = label(args), the callee frame starts frame bytes below this one, its return value is at imm
+        WRITE,       // write(lhs), the library routine gets a frame starting frame bytes below this one
+        READ,        // frame[imm] = read(), dst is a scratch register
+        JUMP,        // goto label
+        BRANCH_ZERO, // if lhs == 0 goto label, otherwise fall through to the next block
+        BRANCH_NONZERO, // if lhs != 0 goto label, otherwise fall through to the next block
+        RETURN,      // return lhs, if any, to the address saved at frame[imm]
+        HALT,
+    };
+
+    std::string_view to_string(Opcode op);
+
+    // Compares or does arithmetic on two registers
+    bool is_binary(Opcode op);
+
+    // Ends a basic block
+    bool is_terminator(Opcode op);
+
+    struct Instruction {
+        Opcode op;
+        VReg dst = no_reg;
+        VReg lhs = no_reg;
+        VReg rhs = no_reg;
+        int imm = 0;
+        int frame = 0;
+        std::string label; // Jump target or callee
+        std::string comment;
+        std::vector<VReg> args; // Arguments of a call passed in registers
+    };
+
+    struct BasicBlock {
+        std::string label; // Empty when the block is only entered by falling through
+        std::vector<Instruction> instructions;
+
+        [[nodiscard]] bool terminated() const {
+            return !instructions.empty() && is_terminator(instructions.back().op);
+        }
+    };
+
+    struct Function {
+        Name name;
+        std::string label;
+        bool is_main = false;
+        int return_address_offset = 0;
+        int return_value_offset = 0;
+        std::vector<int> register_params; // Slots the parameters passed in registers are stored to on entry
+        int registers = 0; // Number of virtual registers used
+        std::vector<BasicBlock> blocks; // In emission order, a block without terminator falls through to the next one
+
+        VReg new_register() { return registers++; }
+    };
+
+    struct Module {
+        CallingConvention convention = CallingConvention::MEMORY;
+        std::vector<Function> functions;
+    };
+
+    std::ostream &operator<<(std::ostream &o, const Instruction &instruction);
+    std::ostream &operator<<(std::ostream &o, const Module &module);
+}
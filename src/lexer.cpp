@@ -7,14 +7,26 @@
 using enum TokenType;
 
 
-Lexer::Lexer(std::istream &in) : input(in), currentChar(0) {
-    input >> std::noskipws;
+Lexer::Lexer(std::istream &in) : input(&in), currentChar(0) {
+    *input >> std::noskipws;
 }
 
+Lexer::Lexer(std::string_view source) : cursor(source.data()), end(source.data() + source.size()), currentChar(0) {}
+
 bool Lexer::advance()
 {
-    if (!(input >> currentChar)) {
-        return false;
+    if (input) {
+        if (!(*input >> currentChar)) {
+            return false;
+        }
+        streamLexeme += currentChar;
+    }
+    else {
+        if (cursor == end) {
+            exhausted = true;
+            return false;
+        }
+        currentChar = *cursor++;
     }
     if (currentChar == '\n') {
         line++;
@@ -23,19 +35,41 @@ bool Lexer::advance()
     return true;
 }
 
+bool Lexer::atEnd() const
+{
+    if (input) {
+        return !input->good();
+    }
+    return exhausted;
+}
+
 char Lexer::peek()
 {
-    return input.peek();
+    if (input) {
+        return input->peek();
+    }
+    if (exhausted || cursor == end) {
+        return EOF;
+    }
+    return *cursor;
 }
 
 // Go back one char
 void Lexer::backup()
 {
-    input.unget();
+    if (input) {
+        if (input->unget() && !streamLexeme.empty()) {
+            streamLexeme.pop_back();
+        }
+    }
+    // Like unget() on a failed stream, backing up after reading past the end does nothing
+    else if (!exhausted) {
+        --cursor;
+    }
     if (currentChar == '\n') {
         line--;
     }
-    currentChar = input.peek();
+    currentChar = peek();
 }
 
 void Lexer::skipWhitespace()
@@ -45,18 +79,13 @@ void Lexer::skipWhitespace()
 
 Token Lexer::comment()
 {
-    std::string str;
-    do {
-        str += currentChar;
-    } while (advance() && currentChar != '\n' && currentChar != '\r');
+    while (advance() && currentChar != '\n' && currentChar != '\r');
     return nextToken();
 }
 
 Token Lexer::multiline_comment()
 {
-    int startline = line;
     int level = 1;
-    std::string str{'/'};
 
     while (level > 0) {
         if (!advance()) {
@@ -65,101 +94,95 @@ Token Lexer::multiline_comment()
         if (currentChar == '\r')
             continue;
 
-        if (currentChar == '\n')
-            str += "\\n";
-        else {
-            str += currentChar;
-        }
-
-        if (currentChar == '/' && input.peek() == '*') {
+        if (currentChar == '/' && peek() == '*') {
             advance();
-            str += currentChar;
             level++;
         }
 
-        else if (currentChar == '*' && input.peek() == '/') {
+        else if (currentChar == '*' && peek() == '/') {
             advance();
-            str += currentChar;
             level--;
         }
     }
 
-    str += '/';
     return nextToken();
 }
 
-bool Lexer::isKeyword(const std::string &str)
+void Lexer::beginLexeme()
 {
-    return keywords.find(str) != keywords.end();
+    if (input) {
+        streamLexeme.assign(1, currentChar);
+    } else {
+        lexemeStart = cursor - 1;
+    }
+    lexemeLength = 1;
 }
 
-bool Lexer::isPunctuation(const std::string &str)
+void Lexer::take()
 {
-    return punctuation.find(str) != punctuation.end();
+    lexemeLength = input ? streamLexeme.size() : cursor - lexemeStart;
+}
+
+std::string_view Lexer::lexeme() const
+{
+    if (input) {
+        return std::string_view(streamLexeme).substr(0, lexemeLength);
+    }
+    return {lexemeStart, lexemeLength};
 }
 
-bool Lexer::isOperator(const std::string &str)
+Token Lexer::makeToken(TokenType type)
 {
-    return operators.find(str) != operators.end();
+    std::string_view text = lexeme();
+    if (input) {
+        // A stream has no buffer to point into, so the text is kept alive by the lexer instead
+        text = streamLexemes.emplace_back(text);
+    }
+    return {type, text, line};
 }
 
 Token Lexer::identifierOrKeyword()
 {
-    std::string str;
     bool invalid_id = false;
 
     if (currentChar == '_') {
         invalid_id = true;
     }
 
+    beginLexeme();
     do {
-        str += currentChar;
+        take();
     } while (advance() && (isalnum(currentChar) || currentChar == '_'));
     backup();
 
     if (invalid_id) {
-        return {INVALID_ID, str, line};
-    }
-    if (isKeyword(str)) {
-        return {keywords[str], str, line};
-    }
-    if (isOperator(str)) {
-        return {operators[str], str, line};
+        return makeToken(INVALID_ID);
     }
 
-    return {IDENTIFIER, str, line};
+    return makeToken(classify_builtin(lexeme(), IDENTIFIER));
 }
 
 Token Lexer::punctuationOrOperator()
 {
-    std::string str {currentChar};
+    beginLexeme();
 
-    char secondChar = input.peek();
+    char secondChar = peek();
     if (secondChar != EOF) {
-        std::string doubleCharOp = str + static_cast<char>(input.peek());
+        const char doubleCharOp[] = {currentChar, secondChar};
+        TokenType type = classify_builtin({doubleCharOp, 2}, INVALID_CHAR);
 
-        if (isOperator(doubleCharOp)) {
+        if (type != INVALID_CHAR) {
             advance();
-            return {operators[doubleCharOp], doubleCharOp, line};
-        }
-        else if (isPunctuation(doubleCharOp)) {
-            advance();
-            return {punctuation[doubleCharOp], doubleCharOp, line};
+            take();
+            return makeToken(type);
         }
     } 
 
-    if (isOperator(str)) {
-        return {operators[str], str, line};
-    }
-    else if (isPunctuation(str)) {
-        return {punctuation[str], str, line};
-    }
-    return {INVALID_CHAR, str, line};
+    return makeToken(classify_builtin(lexeme(), INVALID_CHAR));
 }
 
 Token Lexer::number()
 {
-    std::string str;
     bool starts_with_zero = false;
     bool error = false;
 
@@ -168,9 +191,10 @@ Token Lexer::number()
     }
 
     // Integer part
+    beginLexeme();
     int num_digits = 0;
     do {
-        str += currentChar;
+        take();
         num_digits++;
     } while (advance() && isdigit(currentChar));
 
@@ -180,25 +204,25 @@ Token Lexer::number()
 
     if (isalpha(currentChar)) {
         do {
-            str += currentChar;
+            take();
         } while (advance() && isalpha(currentChar));
 
-        return {INVALID_ID, str, line};
+        return makeToken(INVALID_ID);
     }
 
     else if (currentChar != '.') {
         backup();
         if (error) {
-            return {INVALID_NUMBER, str, line};
+            return makeToken(INVALID_NUMBER);
         } else {
-            return {INTLIT, str, line};
+            return makeToken(INTLIT);
         }
     }
 
     // Decimal part
     int decimal_places = -1;
     do {
-        str += currentChar;
+        take();
         decimal_places++;
     } while (advance() && isdigit(currentChar));
 
@@ -206,24 +230,24 @@ Token Lexer::number()
         error = true;
     }
 
-    if (str.back() == '0' && decimal_places != 1) {
+    if (lexeme().back() == '0' && decimal_places != 1) {
         error = true;
     }
 
     if (currentChar != 'e') {
         backup();
         if (error) {
-            return {INVALID_NUMBER, str, line};
+            return makeToken(INVALID_NUMBER);
         } else {
-            return {FLOATLIT, str, line};
+            return makeToken(FLOATLIT);
         }
     }
 
     // 'e' part
-    str += currentChar;
+    take();
     advance();
     if (currentChar == '-' || currentChar == '+') {
-        str += currentChar;
+        take();
         advance();
     }
 
@@ -235,7 +259,7 @@ Token Lexer::number()
 
     num_digits = 0;
     do {
-        str += currentChar;
+        take();
         num_digits++;
     } while (advance() && isdigit(currentChar));
 
@@ -246,23 +270,23 @@ Token Lexer::number()
     backup();
 
     if (error) {
-        return {INVALID_NUMBER, str, line};
+        return makeToken(INVALID_NUMBER);
     }
 
-    return {FLOATLIT, str, line};
+    return makeToken(FLOATLIT);
 }
 
 Token Lexer::nextToken()
 {
     advance();
-    if (!input.good())
+    if (atEnd())
     {
         return {EOF_TOKEN, line};
     }
 
     skipWhitespace();
     // Check if space
-    if (input.eof()) {
+    if (atEnd()) {
         return {EOF_TOKEN, line};
     }
 
@@ -1,11 +1,13 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <deque>
 #include <map>
 #include <string>
 #include <iostream>
 #include <string_view>
 #include <unordered_set>
-#include <unordered_map>
 #include <utility>
 
 enum class TokenType {
@@ -33,110 +35,23 @@ enum class TokenType {
 
 struct Token {
     TokenType type;
-    std::string value;
+    std::string_view value; // Points into the source buffer, copy it if it has to outlive the lexer
     int line = 0;
 
-    Token(TokenType type, std::string str, int line) : type(type), value(std::move(str)), line(line) {};
+    Token(TokenType type, std::string_view str, int line) : type(type), value(str), line(line) {};
 
     Token(TokenType type, int line) : type(type), line(line) {};
 
     Token() = default;
 };
 
-class Lexer {
-public:
-    explicit Lexer(std::istream &input);
-
-    Token nextToken();
-
-
-private:
-    std::istream &input;
-    char currentChar{};
-    int line = 1;
-
-    bool advance();
-
-    char peek();
-
-    void backup();
-
-    void skipWhitespace();
-
-    Token comment();
-
-    Token multiline_comment();
-
-    Token number();
-
-    Token identifierOrKeyword();
-
-    Token punctuationOrOperator();
-
-    bool isKeyword(const std::string &str);
-
-    bool isPunctuation(const std::string &str);
-
-    bool isOperator(const std::string &str);
-
-
-    std::unordered_map<std::string, TokenType> keywords = {
-            {"int",            TokenType::INT},
-            {"while",          TokenType::WHILE},
-            {"float",          TokenType::FLOAT},
-            {"local",          TokenType::LOCAL},
-            {"if",             TokenType::IF},
-            {"void",           TokenType::VOID},
-            {"constructor",    TokenType::CONSTRUCTOR},
-            {"then",           TokenType::THEN},
-            {"class",          TokenType::CLASS},
-            {"else",           TokenType::ELSE},
-            {"attribute",      TokenType::ATTRIBUTE},
-            {"function",       TokenType::FUNCTION},
-            {"self",           TokenType::SELF},
-            {"read",           TokenType::READ},
-            {"public",         TokenType::PUBLIC},
-            {"isa",            TokenType::ISA},
-            {"write",          TokenType::WRITE},
-            {"implementation", TokenType::IMPLEMENTATION},
-            {"return",         TokenType::RETURN},
-            {"private",        TokenType::PRIVATE},
-    };
-
-    std::unordered_map<std::string, TokenType> operators = {
-            {"==",  TokenType::EQ},
-            {"<>",  TokenType::NEQ},
-            {"<",   TokenType::LT},
-            {">",   TokenType::GT},
-            {"<=",  TokenType::LTEQ},
-            {">=",  TokenType::GTEQ},
-            {"+",   TokenType::ADD},
-            {"-",   TokenType::SUB},
-            {"*",   TokenType::MUL},
-            {"/",   TokenType::DIV},
-            {":=",  TokenType::ASSIGN},
-            {"or",  TokenType::OR},
-            {"and", TokenType::AND},
-            {"not", TokenType::NOT},
-    };
-
-    std::unordered_map<std::string, TokenType> punctuation = {
-            {",",  TokenType::COMMA},
-            {";",  TokenType::SEMICOLON},
-            {"(",  TokenType::LPAREN},
-            {")",  TokenType::RPAREN},
-            {"{",  TokenType::LBRACE},
-            {"}",  TokenType::RBRACE},
-            {"[",  TokenType::LBRACKET},
-            {"]",  TokenType::RBRACKET},
-            {".",  TokenType::DOT},
-            {":",  TokenType::COLON},
-            {"=>", TokenType::ARROW},
-    };
+struct Spelling {
+    std::string_view text;
+    TokenType type;
 };
 
-// Combination of punctuation and operators and keywords
-static std::unordered_map<std::string, TokenType> allBuiltins = {
+// Keywords, operators and punctuation recognized by the lexer
+inline constexpr Spelling lexer_spellings[] = {
         {"int",            TokenType::INT},
         {"while",          TokenType::WHILE},
         {"float",          TokenType::FLOAT},
@@ -150,7 +65,6 @@ static std::unordered_map<std::string, TokenType> allBuiltins = {
         {"attribute",      TokenType::ATTRIBUTE},
         {"function",       TokenType::FUNCTION},
         {"self",           TokenType::SELF},
-        {"identifier",     TokenType::IDENTIFIER},
         {"read",           TokenType::READ},
         {"public",         TokenType::PUBLIC},
         {"isa",            TokenType::ISA},
@@ -183,14 +97,161 @@ static std::unordered_map<std::string, TokenType> allBuiltins = {
         {".",              TokenType::DOT},
         {":",              TokenType::COLON},
         {"=>",             TokenType::ARROW},
-        {"epsilon",        TokenType::EPSILON},
 };
 
-static std::string find_builtin(TokenType type) {
-    for (const auto &pair : allBuiltins) {
-        if (pair.second == type) {
-            return pair.first;
+/*
+ * Perfect hash over lexer_spellings, generated at compile time. The hash only looks at the length and the first,
+ * second and last characters; find_params() searches for a multiplier and table size with no collisions, so a lookup
+ * is one hash, one table load and one string compare.
+ */
+namespace spelling_hash {
+    constexpr std::size_t max_length = 14; // "implementation"
+    constexpr std::uint8_t empty_slot = 0xFF;
+
+    struct Params {
+        std::size_t multiplier = 0;
+        std::size_t size = 0;
+    };
+
+    constexpr std::size_t hash(std::string_view str, std::size_t multiplier) {
+        std::size_t h = str.size();
+        h = h * multiplier + static_cast<unsigned char>(str[0]);
+        h = h * multiplier + static_cast<unsigned char>(str[str.size() > 1 ? 1 : 0]);
+        h = h * multiplier + static_cast<unsigned char>(str.back());
+        return h;
+    }
+
+    constexpr Params find_params() {
+        for (std::size_t size = std::size(lexer_spellings); size < empty_slot; size++) {
+            for (std::size_t multiplier = 2; multiplier < 64; multiplier++) {
+                bool used[empty_slot] = {};
+                bool collision = false;
+                for (const auto &spelling: lexer_spellings) {
+                    std::size_t slot = hash(spelling.text, multiplier) % size;
+                    if (used[slot]) {
+                        collision = true;
+                        break;
+                    }
+                    used[slot] = true;
+                }
+                if (!collision) {
+                    return {multiplier, size};
+                }
+            }
+        }
+        return {};
+    }
+
+    inline constexpr Params params = find_params();
+    static_assert(params.size != 0, "No perfect hash found for the lexer spellings");
+
+    // Index into lexer_spellings for every hash slot
+    inline constexpr auto slots = [] {
+        std::array<std::uint8_t, params.size> table{};
+        table.fill(empty_slot);
+        for (std::size_t i = 0; i < std::size(lexer_spellings); i++) {
+            table[hash(lexer_spellings[i].text, params.multiplier) % params.size] = i;
+        }
+        return table;
+    }();
+}
+
+/**
+ * Classifies a keyword, operator or punctuation
+ * @param str text of the lexeme
+ * @param fallback returned when str is not a builtin, e.g. IDENTIFIER or INVALID_CHAR
+ */
+constexpr TokenType classify_builtin(std::string_view str, TokenType fallback) {
+    if (str.empty() || str.size() > spelling_hash::max_length) {
+        return fallback;
+    }
+    std::uint8_t index = spelling_hash::slots[spelling_hash::hash(str, spelling_hash::params.multiplier) %
+                                              spelling_hash::params.size];
+    if (index == spelling_hash::empty_slot || lexer_spellings[index].text != str) {
+        return fallback;
+    }
+    return lexer_spellings[index].type;
+}
+
+static_assert([] {
+    for (const auto &spelling: lexer_spellings) {
+        if (classify_builtin(spelling.text, TokenType::EPSILON) != spelling.type) {
+            return false;
         }
     }
-    return "Undefined";
+    return classify_builtin("iff", TokenType::IDENTIFIER) == TokenType::IDENTIFIER;
+}());
+
+class Lexer {
+public:
+    // Reads the source one character at a time from a stream
+    explicit Lexer(std::istream &input);
+
+    // Scans a source buffer that must outlive the lexer (see SourceBuffer)
+    explicit Lexer(std::string_view source);
+
+    Token nextToken();
+
+
+private:
+    std::istream *input = nullptr;
+    const char *cursor = nullptr;
+    const char *end = nullptr;
+    bool exhausted = false; // Buffer mode equivalent of the stream's fail state
+    const char *lexemeStart = nullptr;
+    std::size_t lexemeLength = 0;
+    std::string streamLexeme; // Characters read from the stream since the start of the lexeme
+    /**
+     * Token text in stream mode, in a deque so the views handed out stay valid. Entries are kept for the lifetime of the
+     * lexer on purpose: tokens promise the same lifetime as the source buffer of the mapped mode, and the compact
+     * derivation holds views to every token until parsing ends. The cost is the size of the source, as in mapped mode.
+     */
+    std::deque<std::string> streamLexemes;
+    char currentChar{};
+    int line = 1;
+
+    bool advance();
+
+    bool atEnd() const;
+
+    char peek();
+
+    void backup();
+
+    void skipWhitespace();
+
+    void beginLexeme();
+
+    void take();
+
+    std::string_view lexeme() const;
+
+    Token makeToken(TokenType type);
+
+    Token comment();
+
+    Token multiline_comment();
+
+    Token number();
+
+    Token identifierOrKeyword();
+
+    Token punctuationOrOperator();
+};
+
+// Spelling of every TokenType, indexed by its value
+inline constexpr auto token_spellings = [] {
+    std::array<std::string_view, static_cast<std::size_t>(TokenType::EPSILON) + 1> table{};
+    table.fill("Undefined");
+    for (const auto &spelling: lexer_spellings) {
+        table[static_cast<std::size_t>(spelling.type)] = spelling.text;
+    }
+    table[static_cast<std::size_t>(TokenType::IDENTIFIER)] = "identifier";
+    table[static_cast<std::size_t>(TokenType::EPSILON)] = "epsilon";
+    return table;
+}();
+
+constexpr std::string_view find_builtin(TokenType type) {
+    auto index = static_cast<std::size_t>(type);
+    return index < token_spellings.size() ? token_spellings[index] : "Undefined";
 }
@@ -0,0 +1,361 @@
+#include "loopoptimizer.h"
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "moon.h"
+#include "moonemitter.h"
+
+using ir::Opcode;
+
+namespace {
+    // Number of instructions writing each register, and reading it
+    void count_registers(const ir::Function &function, std::vector<int> &defs, std::vector<int> &uses) {
+        defs.assign(function.registers, 0);
+        uses.assign(function.registers, 0);
+        for (const auto &block: function.blocks) {
+            for (const auto &i: block.instructions) {
+                if (i.dst != ir::no_reg) {
+                    defs[i.dst]++;
+                }
+                for (auto reg: {i.lhs, i.rhs}) {
+                    if (reg != ir::no_reg) {
+                        uses[reg]++;
+                    }
+                }
+                for (auto arg: i.args) {
+                    uses[arg]++;
+                }
+            }
+        }
+    }
+}
+
+int LoopOptimizer::run(ir::Module &module, AnalysisCache &analyses) {
+    int changes = 0;
+    for (auto &function: module.functions) {
+        Report report = {.function = function.name};
+        // Instructions move between blocks but no block is added or removed, the loops stay the same
+        const auto &cfg = analyses.cfg(function);
+        for (const auto &loop: cfg.loops()) {
+            report.loops++;
+            const auto entering = preheader(cfg, loop);
+            if (!entering || has_call(function, loop)) {
+                report.skipped++;
+                continue;
+            }
+            const auto original = function;
+            const int hoisted = hoist(function, loop, *entering);
+            const int reduced = reduce(function, cfg, loop, *entering);
+            if (!MoonEmitter::fits_registers(function)) {
+                function = original;
+                report.skipped++;
+                continue;
+            }
+            report.hoisted += hoisted;
+            report.reduced += reduced;
+        }
+        if (report.hoisted + report.reduced > 0) {
+            analyses.invalidate(function, AnalysisCache::Preserved::CFG);
+            changes += report.hoisted + report.reduced;
+        }
+        reports.push_back(report);
+    }
+    return changes;
+}
+
+std::optional<int> LoopOptimizer::preheader(const CFG &cfg, const Loop &loop) {
+    std::optional<int> result;
+    for (auto predecessor: cfg.predecessors(loop.header)) {
+        if (!cfg.reachable(predecessor) ||
+            std::find(loop.blocks.begin(), loop.blocks.end(), predecessor) != loop.blocks.end()) {
+            continue;
+        }
+        if (result) {
+            return std::nullopt;
+        }
+        result = predecessor;
+    }
+    if (!result || cfg.successors(*result).size() != 1) {
+        return std::nullopt;
+    }
+    return result;
+}
+
+bool LoopOptimizer::has_call(const ir::Function &function, const Loop &loop) {
+    for (auto block: loop.blocks) {
+        for (const auto &i: function.blocks[block].instructions) {
+            if (i.op == Opcode::CALL || i.op == Opcode::WRITE || i.op == Opcode::READ) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void LoopOptimizer::insert(ir::BasicBlock &preheader, std::vector<ir::Instruction> instructions) {
+    auto &target = preheader.instructions;
+    auto position = preheader.terminated() ? target.end() - 1 : target.end();
+    target.insert(position, std::make_move_iterator(instructions.begin()), std::make_move_iterator(instructions.end()));
+}
+
+int LoopOptimizer::hoist(ir::Function &function, const Loop &loop, int preheader) {
+    std::vector<int> defs;
+    std::vector<int> uses;
+    count_registers(function, defs, uses);
+    std::unordered_set<int> written; // Slots
+    std::vector<bool> defined(function.registers, false); // In the loop
+    for (auto block: loop.blocks) {
+        for (const auto &i: function.blocks[block].instructions) {
+            if (i.dst != ir::no_reg) {
+                defined[i.dst] = true;
+            }
+            if (i.op == Opcode::STORE || i.op == Opcode::READ) {
+                written.insert(i.imm);
+            }
+        }
+    }
+
+    // Division is left where it is, hoisting it out of a branch could divide by zero where the program did not
+    auto invariant = [&](const ir::Instruction &i) {
+        const bool pure = i.op == Opcode::CONST || (i.op == Opcode::LOAD && !written.contains(i.imm)) ||
+                          (ir::is_binary(i.op) && i.op != Opcode::DIV);
+        return pure && defs[i.dst] == 1 && (i.lhs == ir::no_reg || !defined[i.lhs]) &&
+               (i.rhs == ir::no_reg || !defined[i.rhs]);
+    };
+    // An instruction whose operands are hoisted becomes invariant in turn, blocks are gone over until none is left
+    std::vector<ir::Instruction> hoisted;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto block: loop.blocks) {
+            auto &instructions = function.blocks[block].instructions;
+            for (auto it = instructions.begin(); it != instructions.end();) {
+                if (!invariant(*it)) {
+                    ++it;
+                    continue;
+                }
+                defined[it->dst] = false;
+                hoisted.push_back(std::move(*it));
+                it = instructions.erase(it);
+                changed = true;
+            }
+        }
+    }
+    const int count = static_cast<int>(hoisted.size());
+    insert(function.blocks[preheader], std::move(hoisted));
+    return count;
+}
+
+int LoopOptimizer::reduce(ir::Function &function, const CFG &cfg, const Loop &loop, int preheader) {
+    std::vector<int> defs;
+    std::vector<int> uses;
+    count_registers(function, defs, uses);
+
+    std::map<int, int> stores; // Instructions writing each slot in the loop
+    std::unordered_map<ir::VReg, Position> defined; // Registers written in the loop
+    for (auto block: loop.blocks) {
+        const auto &instructions = function.blocks[block].instructions;
+        for (int index = 0; index < static_cast<int>(instructions.size()); index++) {
+            const auto &i = instructions[index];
+            if (i.op == Opcode::STORE || i.op == Opcode::READ) {
+                stores[i.imm]++;
+            }
+            if (i.dst != ir::no_reg) {
+                defined[i.dst] = {block, index};
+            }
+        }
+    }
+    auto at = [&](Position position) -> const ir::Instruction & {
+        return function.blocks[position.block].instructions[position.index];
+    };
+    // The instruction of the loop writing a register, when it is the only one
+    auto definition = [&](ir::VReg reg) -> std::optional<Position> {
+        const auto it = defined.find(reg);
+        if (it == defined.end() || defs[reg] != 1) {
+            return std::nullopt;
+        }
+        return it->second;
+    };
+
+    /*
+     * Basic induction variables: a slot written once in the loop, by a store of its value loaded in the loop plus or
+     * minus a constant. Value numbering shares loads between blocks, so the load can be anywhere it is still the value
+     * of the slot when the store happens.
+     */
+    struct Induction {
+        Position store;
+        Position value; // Of the store
+        int step;
+    };
+    std::map<int, Induction> variables; // By slot
+    for (auto block: loop.blocks) {
+        const auto &instructions = function.blocks[block].instructions;
+        for (int index = 0; index < static_cast<int>(instructions.size()); index++) {
+            const auto &stored = instructions[index];
+            if (stored.op != Opcode::STORE || stores[stored.imm] != 1) {
+                continue;
+            }
+            const Position store = {block, index};
+            const auto value = definition(stored.lhs);
+            if (!value || (at(*value).op != Opcode::ADD && at(*value).op != Opcode::SUB) ||
+                at(*value).rhs != ir::no_reg) {
+                continue;
+            }
+            const auto loaded = definition(at(*value).lhs);
+            if (!loaded || at(*loaded).op != Opcode::LOAD || at(*loaded).imm != stored.imm ||
+                !precedes(cfg, *loaded, store) || reaches(function, cfg, loop, store, store, *loaded)) {
+                continue;
+            }
+            variables[stored.imm] = {store, *value, at(*value).op == Opcode::ADD ? at(*value).imm : -at(*value).imm};
+        }
+    }
+    if (variables.empty()) {
+        return 0;
+    }
+
+    // The register holding the value of a slot times a factor, on every iteration
+    std::map<std::pair<int, int>, ir::VReg> induction;
+    std::vector<ir::Instruction> initial;
+    int reduced = 0;
+    for (auto block: loop.blocks) {
+        auto &instructions = function.blocks[block].instructions;
+        for (int index = 0; index < static_cast<int>(instructions.size()); index++) {
+            auto &i = instructions[index];
+            if (i.op != Opcode::MUL || i.rhs != ir::no_reg || defs[i.dst] != 1) {
+                continue;
+            }
+            /*
+             * The factor is multiplied by the variable: a value loaded that it has not been stored over since, or the
+             * value stored when it comes from the same block and the store runs first
+             */
+            const auto operand = definition(i.lhs);
+            if (!operand) {
+                continue;
+            }
+            const Position product = {block, index};
+            auto variable = variables.end();
+            if (at(*operand).op == Opcode::LOAD) {
+                variable = variables.find(at(*operand).imm);
+                if (variable != variables.end() && (!precedes(cfg, *operand, product) ||
+                                                    reaches(function, cfg, loop, variable->second.store, product,
+                                                            *operand))) {
+                    variable = variables.end();
+                }
+            } else {
+                variable = std::find_if(variables.begin(), variables.end(), [&](const auto &entry) {
+                    const auto &[store, value, step] = entry.second;
+                    return value == *operand && store.block == value.block && precedes(cfg, store, product);
+                });
+            }
+            if (variable == variables.end() ||
+                !moon::fits_immediate(static_cast<long long>(variable->second.step) * i.imm)) {
+                continue;
+            }
+            const int slot = variable->first;
+
+            auto [it, added] = induction.try_emplace({slot, i.imm}, ir::no_reg);
+            if (added) {
+                it->second = function.new_register();
+                const ir::VReg value = function.new_register();
+                initial.push_back({.op = Opcode::LOAD, .dst = value, .imm = slot});
+                initial.push_back({.op = Opcode::MUL, .dst = it->second, .lhs = value, .imm = i.imm});
+            }
+            /*
+             * The product is the induction register until the next store of the variable. Reads before it take the
+             * register itself, and the copy left for the others goes away with dead code elimination when there are
+             * none, as does the load when nothing else reads it.
+             */
+            std::vector<ir::VReg *> operands;
+            for (auto user: loop.blocks) {
+                auto &code = function.blocks[user].instructions;
+                for (int position = 0; position < static_cast<int>(code.size()); position++) {
+                    if (reaches(function, cfg, loop, variable->second.store, {user, position}, product)) {
+                        continue;
+                    }
+                    for (auto *reg: {&code[position].lhs, &code[position].rhs}) {
+                        if (*reg == i.dst) {
+                            operands.push_back(reg);
+                        }
+                    }
+                }
+            }
+            if (static_cast<int>(operands.size()) == uses[i.dst]) {
+                for (auto *reg: operands) {
+                    *reg = it->second;
+                }
+            }
+            i = {.op = Opcode::ADD, .dst = i.dst, .lhs = it->second, .imm = 0};
+            reduced++;
+        }
+    }
+
+    // Each store of an induction variable is followed by the increase of its registers
+    for (auto block: loop.blocks) {
+        auto &instructions = function.blocks[block].instructions;
+        for (std::size_t index = 0; index < instructions.size(); index++) {
+            if (instructions[index].op != Opcode::STORE) {
+                continue;
+            }
+            const int slot = instructions[index].imm;
+            for (const auto &[key, reg]: induction) {
+                if (key.first == slot) {
+                    instructions.insert(instructions.begin() + static_cast<std::ptrdiff_t>(++index),
+                                        {.op = Opcode::ADD,
+                                         .dst = reg,
+                                         .lhs = reg,
+                                         .imm = variables.at(slot).step * key.second});
+                }
+            }
+        }
+    }
+    insert(function.blocks[preheader], std::move(initial));
+    return reduced;
+}
+
+bool LoopOptimizer::precedes(const CFG &cfg, Position before, Position after) {
+    return before.block == after.block ? before.index < after.index : cfg.dominates(before.block, after.block);
+}
+
+bool LoopOptimizer::reaches(const ir::Function &function, const CFG &cfg, const Loop &loop, Position from,
+                            Position to, Position avoided) {
+    std::vector<bool> visited(function.blocks.size(), false);
+    std::vector<Position> pending = {{from.block, from.index + 1}};
+    while (!pending.empty()) {
+        const auto [block, start] = pending.back();
+        pending.pop_back();
+        const auto size = static_cast<int>(function.blocks[block].instructions.size());
+        bool blocked = false;
+        for (int index = start; index < size && !blocked; index++) {
+            const Position position = {block, index};
+            if (position == to) {
+                return true;
+            }
+            blocked = position == avoided;
+        }
+        if (blocked) {
+            continue;
+        }
+        for (auto successor: cfg.successors(block)) {
+            if (!visited[successor] &&
+                std::find(loop.blocks.begin(), loop.blocks.end(), successor) != loop.blocks.end()) {
+                visited[successor] = true;
+                pending.push_back({successor, 0});
+            }
+        }
+    }
+    return false;
+}
+
+void LoopOptimizer::print_report(std::ostream &o) const {
+    for (const auto &report: reports) {
+        o << report.function << ": " << report.loops << " loops, " << report.hoisted << " instructions hoisted, "
+          << report.reduced << " multiplications reduced";
+        if (report.skipped > 0) {
+            o << ", " << report.skipped << " loops left alone";
+        }
+        o << '\n';
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <optional>
+#include <ostream>
+#include <vector>
+
+#include "cfg.h"
+#include "ir.h"
+#include "passmanager.h"
+
+/**
+ * Moves the computations of a loop that give the same value on every iteration to the block entering it, and replaces
+ * the multiplications of an induction variable by a constant with a register that is increased along with the
+ * variable. Inner loops are handled first, so what they hoist can leave the loops around them too.
+ *
+ * Hoisted values and induction registers stay in a register over the whole loop. Calls and library routines clobber
+ * every register, so loops doing either are left alone, and so are loops whose values would not fit in the registers
+ * of MoonEmitter afterwards.
+ */
+class LoopOptimizer : public Pass {
+public:
+    [[nodiscard]] std::string_view name() const override { return "loop-optimization"; }
+    // Instructions hoisted and multiplications reduced
+    int run(ir::Module &module, AnalysisCache &analyses) override;
+
+    // Loops found in each function and what was done to them
+    void print_report(std::ostream &o) const override;
+
+private:
+    struct Report {
+        Name function;
+        int loops = 0;
+        int hoisted = 0; // Instructions
+        int reduced = 0; // Multiplications
+        int skipped = 0; // Loops left alone
+    };
+
+    std::vector<Report> reports;
+
+    // An instruction of a function
+    struct Position {
+        int block;
+        int index;
+
+        bool operator==(const Position &) const = default;
+    };
+
+    // Only block entering the loop from outside, when it goes nowhere else
+    static std::optional<int> preheader(const CFG &cfg, const Loop &loop);
+    static bool has_call(const ir::Function &function, const Loop &loop);
+    static void insert(ir::BasicBlock &preheader, std::vector<ir::Instruction> instructions);
+
+    static int hoist(ir::Function &function, const Loop &loop, int preheader);
+    static int reduce(ir::Function &function, const CFG &cfg, const Loop &loop, int preheader);
+
+    // Whether an instruction runs before another one every time the loop gets to it
+    static bool precedes(const CFG &cfg, Position before, Position after);
+    // Whether a path in the loop leads from just after an instruction to another one without going through a third
+    static bool reaches(const ir::Function &function, const CFG &cfg, const Loop &loop, Position from, Position to,
+                        Position avoided);
+};
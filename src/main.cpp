@@ -1,21 +1,159 @@
 #include <fstream>
+#include <optional>
 
+#include "dataflow.h"
+#include "deadcode.h"
+#include "inliner.h"
 #include "lexer.h"
+#include "loopoptimizer.h"
+#include "moonemitter.h"
 #include "parser.h"
+#include "passmanager.h"
+#include "peephole.h"
+#include "sourcebuffer.h"
+#include "valuenumbering.h"
 #include "visitor/codegenvisitor.h"
+#include "visitor/constfoldvisitor.h"
 #include "visitor/memsizevisitor.h"
 #include "visitor/semvisitor.h"
 #include "visitor/symtablevisitor.h"
 
 int main(int argc, char* argv[])
 {
-    if (argc != 2) {
+    std::string filename;
+    bool stream_lexer = false; // Read the source through std::istream instead of a mapped buffer
+    bool emit_ir = false; // Write the three-address code to .outir
+    bool emit_cfg = false; // Write the control flow graphs and the dataflow facts of their blocks to .outcfg
+    bool analysis_stats = false; // Print the time spent in each dataflow analysis
+    bool fold_constants = true;
+    bool peephole_optimize = true;
+    bool peephole_stats = false; // Print how often each peephole pattern applied
+    int inline_threshold = 20; // Largest function inlined, in three-address instructions
+    bool inline_report = false; // Print which calls were inlined
+    std::optional<ValueNumbering::Scope> value_numbering = ValueNumbering::Scope::DOMINATORS;
+    bool value_numbering_report = false; // Print the instructions value numbering removed from each function
+    bool optimize_loops = true;
+    bool loop_report = false; // Print what was hoisted out of the loops of each function
+    bool eliminate_dead_code = true;
+    bool dead_code_report = false; // Print the code removed from each function
+    bool pass_stats = false; // Print the time and changes of each pass over the three-address code
+    ir::CallingConvention calling_convention = ir::CallingConvention::MEMORY;
+    DerivationMode derivation_mode = DerivationMode::FULL;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-O0" || arg == "-O1" || arg == "-O2") {
+            // Sets the passes of the level, the flags after it can still turn them on or off one by one
+            const auto level = static_cast<OptimizationLevel>(arg[2] - '0');
+            fold_constants = level != OptimizationLevel::O0;
+            peephole_optimize = level != OptimizationLevel::O0;
+            inline_threshold = level == OptimizationLevel::O2 ? 20 : 0;
+            value_numbering = level == OptimizationLevel::O0 ? std::nullopt
+                            : level == OptimizationLevel::O1 ? std::optional(ValueNumbering::Scope::LOCAL)
+                                                             : std::optional(ValueNumbering::Scope::DOMINATORS);
+            optimize_loops = level == OptimizationLevel::O2;
+            eliminate_dead_code = level != OptimizationLevel::O0;
+        }
+        else if (arg == "--stream-lexer") {
+            stream_lexer = true;
+        }
+        else if (arg == "--emit-ir") {
+            emit_ir = true;
+        }
+        else if (arg == "--emit-cfg") {
+            emit_cfg = true;
+        }
+        else if (arg == "--analysis-stats") {
+            analysis_stats = true;
+        }
+        else if (arg == "--no-constant-folding") {
+            fold_constants = false;
+        }
+        else if (arg == "--no-peephole") {
+            peephole_optimize = false;
+        }
+        else if (arg == "--peephole-stats") {
+            peephole_stats = true;
+        }
+        else if (arg.starts_with("--inline-threshold=")) {
+            try {
+                inline_threshold = std::stoi(arg.substr(arg.find('=') + 1));
+            } catch (const std::logic_error &) {
+                std::cerr << "Invalid inline threshold " << arg << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--inline-report") {
+            inline_report = true;
+        }
+        else if (arg == "--value-numbering=off") {
+            value_numbering.reset();
+        }
+        else if (arg == "--value-numbering=local") {
+            value_numbering = ValueNumbering::Scope::LOCAL;
+        }
+        else if (arg == "--value-numbering=dominators") {
+            value_numbering = ValueNumbering::Scope::DOMINATORS;
+        }
+        else if (arg == "--value-numbering-report") {
+            value_numbering_report = true;
+        }
+        else if (arg == "--no-loop-optimization") {
+            optimize_loops = false;
+        }
+        else if (arg == "--loop-report") {
+            loop_report = true;
+        }
+        else if (arg == "--no-dead-code-elimination") {
+            eliminate_dead_code = false;
+        }
+        else if (arg == "--dead-code-report") {
+            dead_code_report = true;
+        }
+        else if (arg == "--pass-stats") {
+            pass_stats = true;
+        }
+        else if (arg == "--calling-convention=memory") {
+            calling_convention = ir::CallingConvention::MEMORY;
+        }
+        else if (arg == "--calling-convention=registers") {
+            calling_convention = ir::CallingConvention::REGISTERS;
+        }
+        else if (arg == "--derivation=off") {
+            derivation_mode = DerivationMode::OFF;
+        }
+        else if (arg == "--derivation=compact") {
+            derivation_mode = DerivationMode::COMPACT;
+        }
+        else if (arg == "--derivation=expanded") {
+            derivation_mode = DerivationMode::EXPANDED;
+        }
+        else if (arg == "--derivation=full") {
+            derivation_mode = DerivationMode::FULL;
+        }
+        else if (filename.empty() && !arg.starts_with("--")) {
+            filename = arg;
+        }
+        else {
+            std::cerr << "Unknown argument " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (filename.empty()) {
         std::cerr << "Please enter one parameter which is the filename" << std::endl;
+        std::cerr << "Usage: compiler [-O0|-O1|-O2] [--stream-lexer] [--emit-ir] [--emit-cfg] [--analysis-stats] "
+                     "[--no-constant-folding] [--no-peephole] [--peephole-stats] [--inline-threshold=N] [--inline-report] "
+                     "[--value-numbering=off|local|dominators] [--value-numbering-report] [--no-loop-optimization] [--loop-report] "
+                     "[--no-dead-code-elimination] [--dead-code-report] [--pass-stats] "
+                     "[--calling-convention=memory|registers] [--derivation=off|compact|expanded|full] <file.src>" << std::endl;
         return 1;
     }
-    std::string filename = argv[1];
-    std::ifstream file(filename);
-    if (!file.is_open()) {
+
+    std::ifstream file;
+    SourceBuffer source;
+    if (stream_lexer) {
+        file.open(filename);
+    }
+    if (stream_lexer ? !file.is_open() : !source.open(filename)) {
         std::cerr << "Could not open file " << filename << std::endl;
         return 1;
     }
@@ -26,7 +164,10 @@ int main(int argc, char* argv[])
 
     // filename without the .src extension
     std::string outfilename = filename.substr(0, filename.length()-4);
-    std::ofstream derivation_file(outfilename + ".outderivation", std::ios::trunc);
+    std::ofstream derivation_file;
+    if (derivation_mode != DerivationMode::OFF) {
+        derivation_file.open(outfilename + ".outderivation", std::ios::trunc);
+    }
     std::ofstream syntax_errors_file(outfilename + ".outsyntaxerrors", std::ios::trunc);
     std::ofstream ast_file(outfilename + ".outast", std::ios::trunc);
     std::ofstream symtable_file(outfilename + ".outsymboltables", std::ios::trunc);
@@ -34,44 +175,82 @@ int main(int argc, char* argv[])
     std::ofstream codegen_file(outfilename + ".m", std::ios::trunc);
     std::ofstream errors_file(outfilename + ".outerrors", std::ios::trunc);
 
-    Lexer lexer(file);
+    Lexer lexer = stream_lexer ? Lexer(file) : Lexer(source.view());
     // Parser parser(lexer, derivation_file, syntax_errors_file, ast_file);
     // SymTableVisitor symtable_visitor(symtable_errors_file);
     // SemanticVisitor sem_visitor(symtable_errors_file);
     // MemSizeVisitor memsize_visitor;
     // CodeGenVisitor codegen_visitor(codegen_file, errors_file);
 
-    Parser parser(lexer, derivation_file, errors_file, ast_file);
-    SymTableVisitor symtable_visitor(errors_file);
-    SemanticVisitor sem_visitor(errors_file);
+    CompilationContext context;
+    Parser parser(lexer, context, derivation_file, errors_file, derivation_mode);
+    SymTableVisitor symtable_visitor(context, errors_file);
+    SemanticVisitor sem_visitor(context, errors_file);
+    ConstFoldVisitor constfold_visitor(context);
     MemSizeVisitor memsize_visitor;
-    CodeGenVisitor codegen_visitor(codegen_file, errors_file);
+    CodeGenVisitor codegen_visitor(errors_file, calling_convention);
 
     AST* root_node = parser.parse();
+    root_node->recPrint(ast_file);
 
     root_node->accept(symtable_visitor);
     root_node->accept(sem_visitor);
 
-    symtable_file << root_node->symbol_table->to_string();
-    if (parser.has_error) {
-        std::cerr << "Error parsing file" << std::endl;
-        return 1;
-    }
-    if (symtable_visitor.has_error) {
-        std::cerr << "Error creating symbol table" << std::endl;
+    if (parser.has_error || symtable_visitor.has_error || sem_visitor.has_error) {
+        // Sizes and offsets are only known after the MemSize pass, the tables are dumped without them
+        symtable_file << root_node->symbol_table->to_string();
+        if (parser.has_error) {
+            std::cerr << "Error parsing file" << std::endl;
+        } else if (symtable_visitor.has_error) {
+            std::cerr << "Error creating symbol table" << std::endl;
+        } else {
+            std::cerr << "Error in semantic analysis" << std::endl;
+        }
         return 1;
     }
-    if (sem_visitor.has_error) {
-        std::cerr << "Error in semantic analysis" << std::endl;
-        return 1;
+    PassManager pass_manager;
+    if (fold_constants) {
+        const auto start = std::chrono::steady_clock::now();
+        root_node->accept(constfold_visitor);
+        pass_manager.record("constant-folding", constfold_visitor.folded + constfold_visitor.propagated,
+                            std::chrono::steady_clock::now() - start);
     }
     root_node->accept(memsize_visitor);
+    symtable_file << root_node->symbol_table->to_string();
     root_node->accept(codegen_visitor);
     if (codegen_visitor.has_error) {
         std::cerr << "Error in code generation" << std::endl;
     }
-
-    root_node->free();
+    Inliner *inliner = inline_threshold > 0 ? &pass_manager.add<Inliner>(inline_threshold) : nullptr;
+    ValueNumbering *numbering = value_numbering ? &pass_manager.add<ValueNumbering>(*value_numbering) : nullptr;
+    LoopOptimizer *loop_optimizer = optimize_loops ? &pass_manager.add<LoopOptimizer>() : nullptr;
+    DeadCodeElimination *dead_code = eliminate_dead_code ? &pass_manager.add<DeadCodeElimination>() : nullptr;
+    pass_manager.run(codegen_visitor.module);
+    for (auto [pass, report]: {std::pair<Pass *, bool>{inliner, inline_report}, {numbering, value_numbering_report},
+                               {loop_optimizer, loop_report}, {dead_code, dead_code_report}}) {
+        if (pass != nullptr && report) {
+            pass->print_report(std::cout);
+        }
+    }
+    if (emit_ir) {
+        std::ofstream ir_file(outfilename + ".outir", std::ios::trunc);
+        ir_file << codegen_visitor.module;
+    }
+    if (emit_cfg) {
+        std::ofstream cfg_file(outfilename + ".outcfg", std::ios::trunc);
+        dataflow::print(cfg_file, codegen_visitor.module);
+    }
+    Peephole peephole;
+    MoonEmitter(codegen_file, peephole_optimize ? &peephole : nullptr).emit(codegen_visitor.module);
+    if (peephole_stats) {
+        peephole.print_stats(std::cout);
+    }
+    if (pass_stats) {
+        pass_manager.print_stats(std::cout);
+    }
+    if (analysis_stats) {
+        dataflow::print_counters(std::cout);
+    }
 
     file.close();
     derivation_file.close();
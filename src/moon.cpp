@@ -0,0 +1,39 @@
+#include "moon.h"
+
+#include <charconv>
+
+namespace moon {
+    std::optional<int> frame_offset(const std::string &operand) {
+        constexpr std::string_view base = "(r14)";
+        if (!operand.ends_with(base)) {
+            return std::nullopt;
+        }
+        int offset = 0;
+        const char *end = operand.data() + operand.size() - base.size();
+        auto [ptr, error] = std::from_chars(operand.data(), end, offset);
+        if (error != std::errc() || ptr != end) {
+            return std::nullopt;
+        }
+        return offset;
+    }
+
+    std::string frame_operand(int offset) {
+        return std::to_string(offset) + "(r14)";
+    }
+
+    std::ostream &operator<<(std::ostream &o, const Line &line) {
+        if (line.is_label()) {
+            o << line.label;
+        }
+        if (line.is_instruction()) {
+            o << '\t' << line.op;
+            for (std::size_t i = 0; i < line.operands.size(); i++) {
+                o << (i == 0 ? " " : ",") << line.operands[i];
+            }
+        }
+        if (!line.comment.empty()) {
+            o << (line.is_instruction() ? " " : "\t") << "% " << line.comment;
+        }
+        return o << '\n';
+    }
+}
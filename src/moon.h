@@ -0,0 +1,36 @@
+#pragma once
+
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * MOON assembly as a list of lines, the form MoonEmitter writes and the peephole optimizer rewrites before they are
+ * printed.
+ */
+namespace moon {
+    // A label, an instruction or a comment, or an instruction with a comment after it
+    struct Line {
+        std::string label;
+        std::string op; // Empty when the line holds no instruction
+        std::vector<std::string> operands;
+        std::string comment;
+
+        [[nodiscard]] bool is_instruction() const { return !op.empty(); }
+        [[nodiscard]] bool is_label() const { return !label.empty(); }
+        [[nodiscard]] bool empty() const { return label.empty() && op.empty() && comment.empty(); }
+    };
+
+    // Immediates and offsets are the signed 16 bit K field of an instruction
+    constexpr bool fits_immediate(long long value) {
+        return value >= -32768 && value <= 32767;
+    }
+
+    // The offset K of an operand K(r14), a slot in the current frame
+    std::optional<int> frame_offset(const std::string &operand);
+
+    std::string frame_operand(int offset);
+
+    std::ostream &operator<<(std::ostream &o, const Line &line);
+}
@@ -0,0 +1,318 @@
+#include "moonemitter.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <stdexcept>
+#include <unordered_set>
+
+using ir::Opcode;
+
+void MoonEmitter::emit(const ir::Module &module) {
+    convention = module.convention;
+    for (const auto &function: module.functions) {
+        emit(function);
+    }
+    output << '\n';
+    output << "% This is used for printing" << '\n';
+    output << std::left << std::setw(10) << "buf" << "res 20" << '\n';
+    output.flush();
+}
+
+void MoonEmitter::emit(const ir::Function &function) {
+    register_pool.clear();
+    for (int i = available_registers; i >= 1; --i) {
+        register_pool.push_back("r" + std::to_string(i));
+    }
+    assigned.clear();
+    preferred.clear();
+
+    const CFG cfg(function);
+    intervals = dataflow::live_intervals(function, cfg);
+    int index = 0;
+    for (const auto &block: function.blocks) {
+        index += static_cast<int>(block.instructions.size());
+    }
+    starting.assign(index, {});
+    ending.assign(index, {});
+    for (ir::VReg reg = 0; reg < function.registers; reg++) {
+        if (intervals[reg].start >= 0) {
+            starting[intervals[reg].start].push_back(reg);
+            ending[intervals[reg].end].push_back(reg);
+        }
+    }
+    for (const auto &block: function.blocks) {
+        for (const auto &instruction: block.instructions) {
+            for (std::size_t arg = 0; arg < instruction.args.size(); arg++) {
+                preferred[instruction.args[arg]] = "r" + std::to_string(arg + 1);
+            }
+        }
+    }
+
+    lines.clear();
+    if (function.is_main) {
+        label("entry");
+        append("addi", {"r14", "r0", "topaddr"}, "Program starts here");
+    }
+    label(function.label);
+    append("sw", {moon::frame_operand(function.return_address_offset), "r15"});
+    for (std::size_t param = 0; param < function.register_params.size(); param++) {
+        append("sw", {moon::frame_operand(function.register_params[param]), "r" + std::to_string(param + 1)});
+    }
+
+    index = 0;
+    for (const auto &block: function.blocks) {
+        if (!block.label.empty()) {
+            label(block.label);
+        }
+        for (const auto &instruction: block.instructions) {
+            emit(instruction, index++);
+        }
+    }
+
+    if (peephole) {
+        peephole->run(lines);
+    }
+    output << "% Function: " << function.name << '\n';
+    for (const auto &line: lines) {
+        output << line;
+    }
+}
+
+void MoonEmitter::emit(const ir::Instruction &instruction, int index) {
+    const auto &i = instruction;
+    // Values live around a loop are defined after some of their uses
+    for (auto reg: starting[index]) {
+        if (reg != i.dst) {
+            allocate(reg);
+        }
+    }
+    if (i.op == Opcode::CALL || i.op == Opcode::WRITE || i.op == Opcode::READ) {
+        // The same register may be passed as several arguments
+        const std::size_t operands =
+            i.lhs != ir::no_reg ? 1 : std::unordered_set<ir::VReg>(i.args.begin(), i.args.end()).size();
+        if (assigned.size() != operands) {
+            throw std::runtime_error("Register live across a call to " + std::string(ir::to_string(i.op)));
+        }
+    }
+
+    const auto frame = std::to_string(i.frame);
+    switch (i.op) {
+        case Opcode::COMMENT:
+            lines.push_back({.comment = i.comment});
+            break;
+        case Opcode::CONST:
+            allocate(i.dst);
+            append("addi", {reg(i.dst), "r0", std::to_string(i.imm)});
+            break;
+        case Opcode::LOAD:
+            allocate(i.dst);
+            append("lw", {reg(i.dst), moon::frame_operand(i.imm)});
+            break;
+        case Opcode::STORE:
+            append("sw", {moon::frame_operand(i.imm), reg(i.lhs)});
+            break;
+        case Opcode::CALL:
+            move_arguments(i.args);
+            for (auto arg: i.args) {
+                release_if_dead(arg, index);
+            }
+            allocate(i.dst);
+            append("addi", {"r14", "r14", frame});
+            append("jl", {"r15", i.label});
+            if (i.dst != ir::no_reg) {
+                if (convention == ir::CallingConvention::REGISTERS) {
+                    append("addi", {reg(i.dst), "r13", "0"});
+                } else {
+                    append("lw", {reg(i.dst), moon::frame_operand(i.imm)});
+                }
+            }
+            append("subi", {"r14", "r14", frame});
+            break;
+        case Opcode::WRITE:
+            // The register of the value is free once it is passed, it is reused for the buffer address
+            append("addi", {"r14", "r14", frame});
+            append("sw", {"-8(r14)", reg(i.lhs)});
+            append("addi", {reg(i.lhs), "r0", "buf"});
+            append("sw", {"-12(r14)", reg(i.lhs)});
+            append("jl", {"r15", "intstr"});
+            append("sw", {"-8(r14)", "r13"});
+            append("jl", {"r15", "putstr"});
+            append("subi", {"r14", "r14", frame});
+            break;
+        case Opcode::READ:
+            allocate(i.dst);
+            append("addi", {"r14", "r14", frame});
+            append("addi", {reg(i.dst), "r0", "buf"});
+            append("sw", {"-8(r14)", reg(i.dst)});
+            append("jl", {"r15", "getstr"});
+            append("addi", {reg(i.dst), "r0", "buf"});
+            append("sw", {"-8(r14)", reg(i.dst)});
+            append("jl", {"r15", "strint"});
+            append("subi", {"r14", "r14", frame});
+            append("sw", {moon::frame_operand(i.imm), "r13"});
+            break;
+        case Opcode::JUMP:
+            append("j", {i.label});
+            break;
+        case Opcode::BRANCH_ZERO:
+        case Opcode::BRANCH_NONZERO:
+            append(std::string(ir::to_string(i.op)), {reg(i.lhs), i.label});
+            break;
+        case Opcode::RETURN:
+            if (i.lhs != ir::no_reg) {
+                append("addi", {"r13", reg(i.lhs), "0"});
+            }
+            append("lw", {"r15", moon::frame_operand(i.imm)});
+            append("jr", {"r15"});
+            break;
+        case Opcode::HALT:
+            append("hlt", {});
+            break;
+        default: {
+            assert(ir::is_binary(i.op));
+            // The destination is allocated after the operands are freed, so it can reuse one of them
+            const std::string lhs = reg(i.lhs);
+            const bool immediate = i.rhs == ir::no_reg;
+            const std::string rhs = immediate ? std::to_string(i.imm) : reg(i.rhs);
+            release_if_dead(i.rhs, index);
+            release_if_dead(i.lhs, index);
+            allocate(i.dst);
+            append(std::string(ir::to_string(i.op)) + (immediate ? "i" : ""), {reg(i.dst), lhs, rhs});
+            break;
+        }
+    }
+    // Operands read for the last time, values that are never read, like the scratch register of a read, and values
+    // live until the end of a block
+    for (auto reg: ending[index]) {
+        release_if_dead(reg, index);
+    }
+}
+
+int MoonEmitter::words(const ir::Instruction &instruction) {
+    switch (instruction.op) {
+        case Opcode::COMMENT:
+            return 0;
+        case Opcode::CALL:
+            return instruction.dst != ir::no_reg ? 4 : 3;
+        case Opcode::WRITE:
+            return 8;
+        case Opcode::READ:
+            return 9;
+        case Opcode::RETURN:
+            return instruction.lhs != ir::no_reg ? 3 : 2;
+        default:
+            return 1;
+    }
+}
+
+void MoonEmitter::move_arguments(const std::vector<ir::VReg> &args) {
+    struct Move {
+        std::string target;
+        std::string source;
+    };
+    std::vector<Move> moves;
+    for (std::size_t arg = 0; arg < args.size(); arg++) {
+        auto target = "r" + std::to_string(arg + 1);
+        if (reg(args[arg]) != target) {
+            moves.push_back({target, reg(args[arg])});
+        }
+    }
+    // A move is done once no other one still reads its target. The arguments are the only live registers, so r13 is
+    // free to break a cycle.
+    while (!moves.empty()) {
+        auto ready = std::find_if(moves.begin(), moves.end(), [&](const Move &move) {
+            return std::none_of(moves.begin(), moves.end(), [&](const Move &other) {
+                return other.source == move.target;
+            });
+        });
+        if (ready != moves.end()) {
+            append("addi", {ready->target, ready->source, "0"});
+            moves.erase(ready);
+            continue;
+        }
+        auto blocked = std::find_if(moves.begin(), moves.end(), [&](const Move &other) {
+            return other.source == moves.front().target;
+        });
+        append("addi", {"r13", blocked->source, "0"});
+        blocked->source = "r13";
+    }
+}
+
+void MoonEmitter::append(std::string op, std::vector<std::string> operands, std::string comment) {
+    lines.push_back({.op = std::move(op), .operands = std::move(operands), .comment = std::move(comment)});
+}
+
+void MoonEmitter::label(std::string name) {
+    lines.push_back({.label = std::move(name)});
+}
+
+const std::string &MoonEmitter::reg(ir::VReg reg) const {
+    auto it = assigned.find(reg);
+    if (it == assigned.end()) {
+        throw std::runtime_error("Virtual register v" + std::to_string(reg) + " used before it is defined");
+    }
+    return it->second;
+}
+
+void MoonEmitter::allocate(ir::VReg reg) {
+    if (reg == ir::no_reg || assigned.contains(reg)) {
+        return;
+    }
+    if (register_pool.empty()) {
+        throw std::runtime_error("No registers available");
+    }
+    // Arguments of a call are put where the callee expects them when that register is free
+    auto it = register_pool.end() - 1;
+    if (auto hint = preferred.find(reg); hint != preferred.end()) {
+        if (auto free = std::find(register_pool.begin(), register_pool.end(), hint->second); free != register_pool.end()) {
+            it = free;
+        }
+    }
+    assigned[reg] = *it;
+    register_pool.erase(it);
+}
+
+void MoonEmitter::release_if_dead(ir::VReg reg, int index) {
+    if (reg == ir::no_reg || intervals[reg].end > index) {
+        return;
+    }
+    if (auto it = assigned.find(reg); it != assigned.end()) {
+        register_pool.push_back(it->second);
+        assigned.erase(it);
+    }
+}
+
+bool MoonEmitter::fits_registers(const ir::Function &function) {
+    const CFG cfg(function);
+    const auto intervals = dataflow::live_intervals(function, cfg);
+    int index = 0;
+    for (const auto &block: function.blocks) {
+        for (const auto &i: block.instructions) {
+            const bool call = i.op == Opcode::CALL || i.op == Opcode::WRITE || i.op == Opcode::READ;
+            // Registers held while the instruction reads its operands, and once its result has one
+            int reading = 0;
+            int written = 0;
+            for (ir::VReg reg = 0; reg < function.registers; reg++) {
+                const auto &interval = intervals[reg];
+                if (interval.start < 0 || interval.start > index || interval.end < index) {
+                    continue;
+                }
+                if (reg == i.dst && interval.start == index) {
+                    written++;
+                    continue;
+                }
+                reading++;
+                written += interval.end > index;
+                if (call && reg != i.lhs && std::find(i.args.begin(), i.args.end(), reg) == i.args.end()) {
+                    return false;
+                }
+            }
+            if (reading > available_registers || written > available_registers) {
+                return false;
+            }
+            index++;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "dataflow.h"
+#include "ir.h"
+#include "moon.h"
+#include "peephole.h"
+
+/**
+ * Writes the MOON assembly for a module of three-address code. Virtual registers get one of r1-r12 for as long as they
+ * are live, r13 to r15 are left to the library and the calling convention.
+ *
+ * A register is held over the live interval of its value, from the first instruction it is live at in emission order to
+ * the last, so a value live around a loop keeps it over the whole loop. Calls and library routines do not preserve
+ * registers, so nothing but their own operands can be live across them.
+ *
+ * The lines of each function go through the peephole optimizer, when one is given, before they are written.
+ */
+class MoonEmitter {
+public:
+    explicit MoonEmitter(std::ostream &output, Peephole *peephole = nullptr) : output(output), peephole(peephole) {}
+
+    // r1 to r12
+    static constexpr int available_registers = 12;
+
+    void emit(const ir::Module &module);
+
+    // Whether no more than the available registers are live at once, and none but its operands across a call
+    static bool fits_registers(const ir::Function &function);
+
+    // MOON instructions an instruction is written as before the peephole optimizer, the moves of arguments aside
+    static int words(const ir::Instruction &instruction);
+
+private:
+    std::ostream &output;
+    Peephole *peephole;
+    ir::CallingConvention convention = ir::CallingConvention::MEMORY;
+    std::vector<moon::Line> lines; // Of the current function
+    std::vector<std::string> register_pool;
+    std::unordered_map<ir::VReg, std::string> assigned;
+    std::vector<dataflow::Interval> intervals;
+    // Registers whose interval starts and ends at each instruction
+    std::vector<std::vector<ir::VReg>> starting;
+    std::vector<std::vector<ir::VReg>> ending;
+    std::unordered_map<ir::VReg, std::string> preferred; // Register an argument is passed in
+
+    void emit(const ir::Function &function);
+    void emit(const ir::Instruction &instruction, int index);
+
+    // Puts the arguments of a call in r1 and up
+    void move_arguments(const std::vector<ir::VReg> &args);
+
+    void append(std::string op, std::vector<std::string> operands, std::string comment = {});
+    void label(std::string name);
+
+    const std::string &reg(ir::VReg reg) const;
+    void allocate(ir::VReg reg);
+    void release_if_dead(ir::VReg reg, int index);
+};
@@ -0,0 +1,36 @@
+#include "name.h"
+
+#include <unordered_set>
+
+namespace {
+    // Hashes string views as well, so lookups do not have to build a std::string
+    struct StringHash {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view str) const { return std::hash<std::string_view>{}(str); }
+    };
+
+    // Function local so names can be created during static initialization
+    std::unordered_set<std::string, StringHash, std::equal_to<>> &strings() {
+        static std::unordered_set<std::string, StringHash, std::equal_to<>> table;
+        return table;
+    }
+
+    const std::string empty_string;
+}
+
+const std::string &Name::str() const {
+    return entry != nullptr ? *entry : empty_string;
+}
+
+const std::string *Name::intern(std::string_view str) {
+    if (str.empty()) {
+        return nullptr;
+    }
+    auto &table = strings();
+    auto it = table.find(str);
+    if (it == table.end()) {
+        it = table.emplace(str).first;
+    }
+    return &*it;
+}
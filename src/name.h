@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+/**
+ * Handle to a string in the global interner. Every distinct string is stored once, so names are a single pointer,
+ * compare and hash in O(1), and stay valid until the program exits. The default name is the empty string.
+ */
+class Name {
+public:
+    Name() = default;
+
+    explicit Name(std::string_view str) : entry(intern(str)) {}
+
+    [[nodiscard]] const std::string &str() const;
+
+    [[nodiscard]] bool empty() const { return entry == nullptr; }
+
+    [[nodiscard]] std::size_t hash() const { return std::hash<const void *>{}(entry); }
+
+    bool operator==(const Name &other) const = default;
+
+    friend std::ostream &operator<<(std::ostream &o, const Name &name) { return o << name.str(); }
+
+private:
+    const std::string *entry = nullptr; // nullptr for the empty string
+
+    static const std::string *intern(std::string_view str);
+};
+
+template<>
+struct std::hash<Name> {
+    std::size_t operator()(const Name &name) const noexcept { return name.hash(); }
+};
+
+// Names the compiler itself looks for
+namespace names {
+    inline const Name int_type{"int"};
+    inline const Name float_type{"float"};
+    inline const Name void_type{"void"};
+    inline const Name bool_type{"bool"};
+    inline const Name type_error{"type_error"};
+    inline const Name global{"global"};
+    inline const Name main_function{"main"};
+    inline const Name return_value{"return"};
+    inline const Name return_address{"jump"};
+    inline const Name visibility_public{"public"};
+}
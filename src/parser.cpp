@@ -4,14 +4,14 @@
 #include "parser.h"
 
 #include <cassert>
+#include <charconv>
 #include <utility>
 #include "lexer.h"
 #include "ast.h"
+#include "tokenset.h"
 
 using enum TokenType;
 
-typedef std::unordered_set<TokenType> tokentype_set;
-
 /*
 START -> PROG
 PROG -> CLASSIMPLFUNC PROG | EPSILON
@@ -90,19 +90,164 @@ IDORSELF -> id | self
 
  */
 
-
-void Parser::error(const std::string &expected) {
+// FIRST and FOLLOW sets of the grammar above, EPSILON marks the nullable nonterminals
+namespace first {
+    constexpr TokenSet START = {CONSTRUCTOR, CLASS, FUNCTION, IMPLEMENTATION, EPSILON};
+    constexpr TokenSet PROG = {CONSTRUCTOR, CLASS, FUNCTION, IMPLEMENTATION, EPSILON};
+    constexpr TokenSet CLASSIMPLFUNC = {CONSTRUCTOR, CLASS, FUNCTION, IMPLEMENTATION};
+    constexpr TokenSet CLASSDECL = {CLASS};
+    constexpr TokenSet VISMEMBERDECL = {PUBLIC, PRIVATE, EPSILON};
+    constexpr TokenSet ISA = {TokenType::ISA, EPSILON};
+    constexpr TokenSet REPTISA = {COMMA, EPSILON};
+    constexpr TokenSet IMPLDEF = {IMPLEMENTATION};
+    constexpr TokenSet IMPLBODY = {CONSTRUCTOR, FUNCTION, EPSILON};
+    constexpr TokenSet FUNCDEF = {CONSTRUCTOR, FUNCTION};
+    constexpr TokenSet VISIBILITY = {PUBLIC, PRIVATE};
+    constexpr TokenSet MEMDECL = {CONSTRUCTOR, ATTRIBUTE, FUNCTION};
+    constexpr TokenSet FUNCDECL = {CONSTRUCTOR, FUNCTION};
+    constexpr TokenSet FUNCHEAD = {CONSTRUCTOR, FUNCTION};
+    constexpr TokenSet FUNCBODY = {LBRACE};
+    constexpr TokenSet LOCALVARDECLORSTAT = {IDENTIFIER, WHILE, LOCAL, IF, SELF, READ, WRITE, RETURN};
+    constexpr TokenSet REPTFUNCBODY = {IDENTIFIER, WHILE, LOCAL, IF, SELF, READ, WRITE, RETURN, EPSILON};
+    constexpr TokenSet ATTRDECL = {ATTRIBUTE};
+    constexpr TokenSet LOCALVARDECL = {LOCAL};
+    constexpr TokenSet VARDECL = {IDENTIFIER};
+    constexpr TokenSet STATEMENT = {IDENTIFIER, WHILE, IF, SELF, READ, WRITE, RETURN};
+    constexpr TokenSet FUNCALLORASSIGN = {IDENTIFIER, SELF};
+    constexpr TokenSet FUNCALLORASSIGN2 = {ASSIGN, LPAREN, LBRACKET, DOT};
+    constexpr TokenSet FUNCALLORASSIGN3 = {ASSIGN, DOT};
+    constexpr TokenSet FUNCALLORASSIGN4 = {DOT, EPSILON};
+    constexpr TokenSet STATBLOCK = {IDENTIFIER, WHILE, IF, SELF, READ, WRITE, RETURN, LBRACE, EPSILON};
+    constexpr TokenSet STATEMENTS = {IDENTIFIER, WHILE, IF, SELF, READ, WRITE, RETURN, EPSILON};
+    constexpr TokenSet EXPR = {IDENTIFIER, INTLIT, FLOATLIT, SELF, ADD, SUB, NOT, LPAREN};
+    constexpr TokenSet EXPR2 = {EQ, NEQ, LT, GT, LTEQ, GTEQ, EPSILON};
+    constexpr TokenSet RELEXPR = {IDENTIFIER, INTLIT, FLOATLIT, SELF, ADD, SUB, NOT, LPAREN};
+    constexpr TokenSet ARITHEXPR = {IDENTIFIER, INTLIT, FLOATLIT, SELF, ADD, SUB, NOT, LPAREN};
+    constexpr TokenSet RIGHTRECARITHEXPR = {ADD, SUB, OR, EPSILON};
+    constexpr TokenSet SIGN = {ADD, SUB};
+    constexpr TokenSet TERM = {IDENTIFIER, INTLIT, FLOATLIT, SELF, ADD, SUB, NOT, LPAREN};
+    constexpr TokenSet RIGHTRECTERM = {MUL, DIV, AND, EPSILON};
+    constexpr TokenSet FACTOR = {IDENTIFIER, INTLIT, FLOATLIT, SELF, ADD, SUB, NOT, LPAREN};
+    constexpr TokenSet FACTOR2 = {LPAREN, LBRACKET, EPSILON};
+    constexpr TokenSet INDICES = {LBRACKET, EPSILON};
+    constexpr TokenSet REPTIDNEST = {DOT, EPSILON};
+    constexpr TokenSet VARIABLE = {IDENTIFIER, SELF};
+    constexpr TokenSet VARIABLE2 = {LPAREN, LBRACKET, DOT, EPSILON};
+    constexpr TokenSet REPTVARIABLE = {DOT, EPSILON};
+    constexpr TokenSet VARIDNEST = {DOT};
+    constexpr TokenSet VARIDNESTTAIL = {LPAREN, LBRACKET, EPSILON};
+    constexpr TokenSet INDICE = {LBRACKET};
+    constexpr TokenSet IDNEST = {DOT};
+    constexpr TokenSet IDNESTTAIL = {LPAREN, LBRACKET, EPSILON};
+    constexpr TokenSet ARRAYSIZE = {LBRACKET};
+    constexpr TokenSet ARRAYSIZE2 = {INTLIT, RBRACKET};
+    constexpr TokenSet ARRAYSIZES = {LBRACKET, EPSILON};
+    constexpr TokenSet TYPE = {IDENTIFIER, INT, FLOAT};
+    constexpr TokenSet RETURNTYPE = {IDENTIFIER, INT, FLOAT, VOID};
+    constexpr TokenSet APARAMS = {IDENTIFIER, INTLIT, FLOATLIT, SELF, ADD, SUB, NOT, LPAREN, EPSILON};
+    constexpr TokenSet REPTAPARAMS1 = {COMMA, EPSILON};
+    constexpr TokenSet APARAMSTAIL = {COMMA};
+    constexpr TokenSet FPARAMS = {IDENTIFIER, EPSILON};
+    constexpr TokenSet REPTFPARAMS1 = {COMMA, EPSILON};
+    constexpr TokenSet FPARAMSTAIL = {COMMA};
+    constexpr TokenSet ASSIGNOP = {ASSIGN};
+    constexpr TokenSet RELOP = {EQ, NEQ, LT, GT, LTEQ, GTEQ};
+    constexpr TokenSet ADDOP = {ADD, SUB, OR};
+    constexpr TokenSet MULTOP = {MUL, DIV, AND};
+    constexpr TokenSet IDORSELF = {IDENTIFIER, SELF};
+}
+
+namespace follow {
+    constexpr TokenSet START = {EOF_TOKEN};
+    constexpr TokenSet PROG = {EOF_TOKEN};
+    constexpr TokenSet CLASSIMPLFUNC = {EOF_TOKEN, CONSTRUCTOR, CLASS, FUNCTION, IMPLEMENTATION};
+    constexpr TokenSet CLASSDECL = {EOF_TOKEN, CONSTRUCTOR, CLASS, FUNCTION, IMPLEMENTATION};
+    constexpr TokenSet VISMEMBERDECL = {RBRACE};
+    constexpr TokenSet ISA = {LBRACE};
+    constexpr TokenSet REPTISA = {LBRACE};
+    constexpr TokenSet IMPLDEF = {EOF_TOKEN, CONSTRUCTOR, CLASS, FUNCTION, IMPLEMENTATION};
+    constexpr TokenSet IMPLBODY = {RBRACE};
+    constexpr TokenSet FUNCDEF = {EOF_TOKEN, CONSTRUCTOR, CLASS, FUNCTION, IMPLEMENTATION, RBRACE};
+    constexpr TokenSet VISIBILITY = {CONSTRUCTOR, ATTRIBUTE, FUNCTION};
+    constexpr TokenSet MEMDECL = {PUBLIC, PRIVATE, RBRACE};
+    constexpr TokenSet FUNCDECL = {PUBLIC, PRIVATE, RBRACE};
+    constexpr TokenSet FUNCHEAD = {SEMICOLON, LBRACE};
+    constexpr TokenSet FUNCBODY = {EOF_TOKEN, CONSTRUCTOR, CLASS, FUNCTION, IMPLEMENTATION, RBRACE};
+    constexpr TokenSet LOCALVARDECLORSTAT = {IDENTIFIER, WHILE, LOCAL, IF, SELF, READ, WRITE, RETURN, RBRACE};
+    constexpr TokenSet REPTFUNCBODY = {RBRACE};
+    constexpr TokenSet ATTRDECL = {PUBLIC, PRIVATE, RBRACE};
+    constexpr TokenSet LOCALVARDECL = {IDENTIFIER, WHILE, LOCAL, IF, SELF, READ, WRITE, RETURN, RBRACE};
+    constexpr TokenSet VARDECL = {IDENTIFIER, WHILE, LOCAL, IF, SELF, READ, PUBLIC, WRITE, RETURN, PRIVATE, RBRACE};
+    constexpr TokenSet STATEMENT = {IDENTIFIER, WHILE, LOCAL, IF, ELSE, SELF, READ, WRITE, RETURN, SEMICOLON, RBRACE};
+    constexpr TokenSet FUNCALLORASSIGN = {SEMICOLON};
+    constexpr TokenSet FUNCALLORASSIGN2 = {SEMICOLON};
+    constexpr TokenSet FUNCALLORASSIGN3 = {SEMICOLON};
+    constexpr TokenSet FUNCALLORASSIGN4 = {SEMICOLON};
+    constexpr TokenSet STATBLOCK = {ELSE, SEMICOLON};
+    constexpr TokenSet STATEMENTS = {RBRACE};
+    constexpr TokenSet EXPR = {COMMA, SEMICOLON, RPAREN};
+    constexpr TokenSet EXPR2 = {COMMA, SEMICOLON, RPAREN};
+    constexpr TokenSet RELEXPR = {RPAREN};
+    constexpr TokenSet ARITHEXPR = {EQ, NEQ, LT, GT, LTEQ, GTEQ, COMMA, SEMICOLON, RPAREN, RBRACKET};
+    constexpr TokenSet RIGHTRECARITHEXPR = {EQ, NEQ, LT, GT, LTEQ, GTEQ, COMMA, SEMICOLON, RPAREN, RBRACKET};
+    constexpr TokenSet SIGN = {IDENTIFIER, INTLIT, FLOATLIT, SELF, ADD, SUB, NOT, LPAREN};
+    constexpr TokenSet TERM = {EQ, NEQ, LT, GT, LTEQ, GTEQ, ADD, SUB, OR, COMMA, SEMICOLON, RPAREN, RBRACKET};
+    constexpr TokenSet RIGHTRECTERM = {EQ, NEQ, LT, GT, LTEQ, GTEQ, ADD, SUB, OR, COMMA, SEMICOLON, RPAREN, RBRACKET};
+    constexpr TokenSet FACTOR = {EQ, NEQ, LT, GT, LTEQ, GTEQ, ADD, SUB, MUL, DIV, OR, AND, COMMA, SEMICOLON, RPAREN,
+            RBRACKET};
+    constexpr TokenSet FACTOR2 = {EQ, NEQ, LT, GT, LTEQ, GTEQ, ADD, SUB, MUL, DIV, OR, AND, COMMA, SEMICOLON, RPAREN,
+            RBRACKET, DOT};
+    constexpr TokenSet INDICES = {EQ, NEQ, LT, GT, LTEQ, GTEQ, ADD, SUB, MUL, DIV, ASSIGN, OR, AND, COMMA, SEMICOLON,
+            RPAREN, RBRACKET, DOT};
+    constexpr TokenSet REPTIDNEST = {EQ, NEQ, LT, GT, LTEQ, GTEQ, ADD, SUB, MUL, DIV, OR, AND, COMMA, SEMICOLON, RPAREN,
+            RBRACKET};
+    constexpr TokenSet VARIABLE = {RPAREN};
+    constexpr TokenSet VARIABLE2 = {RPAREN};
+    constexpr TokenSet REPTVARIABLE = {RPAREN};
+    constexpr TokenSet VARIDNEST = {RPAREN, DOT};
+    constexpr TokenSet VARIDNESTTAIL = {RPAREN, DOT};
+    constexpr TokenSet INDICE = {EQ, NEQ, LT, GT, LTEQ, GTEQ, ADD, SUB, MUL, DIV, ASSIGN, OR, AND, COMMA, SEMICOLON,
+            RPAREN, LBRACKET, RBRACKET, DOT};
+    constexpr TokenSet IDNEST = {EQ, NEQ, LT, GT, LTEQ, GTEQ, ADD, SUB, MUL, DIV, OR, AND, COMMA, SEMICOLON, RPAREN,
+            RBRACKET, DOT};
+    constexpr TokenSet IDNESTTAIL = {EQ, NEQ, LT, GT, LTEQ, GTEQ, ADD, SUB, MUL, DIV, OR, AND, COMMA, SEMICOLON, RPAREN,
+            RBRACKET, DOT};
+    constexpr TokenSet ARRAYSIZE = {COMMA, SEMICOLON, RPAREN, LBRACKET};
+    constexpr TokenSet ARRAYSIZE2 = {COMMA, SEMICOLON, RPAREN, LBRACKET};
+    constexpr TokenSet ARRAYSIZES = {COMMA, SEMICOLON, RPAREN};
+    constexpr TokenSet TYPE = {COMMA, SEMICOLON, RPAREN, LBRACE, LBRACKET};
+    constexpr TokenSet RETURNTYPE = {SEMICOLON, LBRACE};
+    constexpr TokenSet APARAMS = {RPAREN};
+    constexpr TokenSet REPTAPARAMS1 = {RPAREN};
+    constexpr TokenSet APARAMSTAIL = {COMMA, RPAREN};
+    constexpr TokenSet FPARAMS = {RPAREN};
+    constexpr TokenSet REPTFPARAMS1 = {RPAREN};
+    constexpr TokenSet FPARAMSTAIL = {COMMA, RPAREN};
+    constexpr TokenSet ASSIGNOP = {IDENTIFIER, INTLIT, FLOATLIT, SELF, ADD, SUB, NOT, LPAREN};
+    constexpr TokenSet RELOP = {IDENTIFIER, INTLIT, FLOATLIT, SELF, ADD, SUB, NOT, LPAREN};
+    constexpr TokenSet ADDOP = {IDENTIFIER, INTLIT, FLOATLIT, SELF, ADD, SUB, NOT, LPAREN};
+    constexpr TokenSet MULTOP = {IDENTIFIER, INTLIT, FLOATLIT, SELF, ADD, SUB, NOT, LPAREN};
+    constexpr TokenSet IDORSELF = {EQ, NEQ, LT, GT, LTEQ, GTEQ, ADD, SUB, MUL, DIV, ASSIGN, OR, AND, COMMA, SEMICOLON,
+            LPAREN, RPAREN, LBRACKET, RBRACKET, DOT};
+}
+
+
+void Parser::error(std::string_view expected) {
     syntax_errors << "Line " << nexttok.line << ": ";
     syntax_errors << "Syntax error: Expected " << expected << " but found " << nexttok.value << std::endl;
     syntax_errors << std::endl;
 }
 
+// The literal is still well formed, parsing goes on but the program is not compiled
+void Parser::literal_error(std::string_view kind) {
+    syntax_errors << "Line " << curtok.line << ": ";
+    syntax_errors << "Syntax error: " << kind << " literal " << curtok.value << " is out of range" << std::endl;
+    syntax_errors << std::endl;
+    has_error = true;
+}
+
 void Parser::print_derivation() {
-    derivations << nexttok.line << ": ";
-    for (const std::string &value: derivation) {
-        derivations << value << ' ';
-    }
-    derivations << std::endl;
+    derivation.print(nexttok.line);
 }
 
 void Parser::nextsym() {
@@ -111,36 +256,19 @@ void Parser::nextsym() {
 }
 
 
-void Parser::insert_derivation(std::initializer_list<std::string> new_derivation) {
-    const auto index = derivation.begin() + derivation_index;
-    if (!derivation.empty() && derivation_index < derivation.size()) {
-        derivation.erase(index);
-    }
-    derivation.insert(index, new_derivation);
-    print_derivation();
+void Parser::insert_derivation(std::initializer_list<std::string_view> new_derivation) {
+    derivation.insert(new_derivation, nexttok.line);
 }
 
-void Parser::accept_token(std::string value) {
-    if (derivation_index >= derivation.size()) {
-        derivation.emplace_back(std::move(value));
-    } else {
-        derivation[derivation_index] = std::move(value);
-    }
-    derivation_index++;
-    print_derivation();
+void Parser::accept_token(std::string_view value) {
+    derivation.accept(value, nexttok.line);
 }
 
 void Parser::accept_epsilon() {
-    if (!derivation.empty()) {
-        derivation.erase(derivation.begin() + derivation_index);
-    }
-}
-
-bool Parser::token_in_values(const std::unordered_set<std::string> &values) const {
-    return values.contains(nexttok.value);
+    derivation.epsilon(nexttok.line);
 }
 
-bool Parser::token_in(const std::unordered_set<TokenType> &types) const {
+bool Parser::token_in(TokenSet types) const {
     return types.contains(nexttok.type);
 }
 
@@ -168,7 +296,7 @@ bool Parser::expect(TokenType type) {
     return false;
 }
 
-bool Parser::skipErrors(const std::unordered_set<TokenType> &first, const std::unordered_set<TokenType> &follow = {}) {
+bool Parser::skipErrors(TokenSet first, TokenSet follow) {
     if (nexttok.type == EOF_TOKEN) {
         return false;
     }
@@ -209,22 +337,21 @@ AST *Parser::parse() {
     insert_derivation({"START"});
     insert_derivation({"PROGRAM"});
 
-    auto p = new AST(ASTType::PROGRAM, nexttok.line);
-    has_error = program(p);
+    auto p = make<AST>(ASTType::PROGRAM, nexttok.line);
+    has_error |= program(p);
 
     accept_epsilon();
     print_derivation();
-
-    p->recPrint(ast_output);
+    derivation.finish();
 
     return p;
 }
 
 
 bool Parser::program(AST *p) {
-    if (!skipErrors({CLASS, IMPLEMENTATION, FUNCTION, EPSILON}, {EOF_TOKEN})) return false;
+    if (!skipErrors(first::PROG, follow::PROG)) return false;
 
-    if (peek(CLASS) || peek(IMPLEMENTATION) || peek(FUNCTION)) {
+    if (token_in(first::CLASSIMPLFUNC)) {
         insert_derivation({"CLASSIMPLFUNC", "PROGRAM"});
         return block(p) & program(p);
     } else if (peek(EOF_TOKEN)) {
@@ -236,21 +363,21 @@ bool Parser::program(AST *p) {
 }
 
 bool Parser::block(AST *p) {
-    if (!skipErrors({CLASS, IMPLEMENTATION, FUNCTION, EPSILON}, {EOF_TOKEN})) return false;
+    if (!skipErrors(first::CLASSIMPLFUNC, follow::CLASSIMPLFUNC)) return false;
 
     if (peek(CLASS)) {
         insert_derivation({"CLASS"});
-        auto c = new AST(ASTType::CLASSDEF, nexttok.line);
+        auto c = make<AST>(ASTType::CLASSDEF, nexttok.line);
         p->adopt(c);
         return classdef(c);
     } else if (peek(IMPLEMENTATION)) {
         insert_derivation({"IMPLEMENTATION"});
-        auto i = new AST(ASTType::IMPLDEF, nexttok.line);
+        auto i = make<AST>(ASTType::IMPLDEF, nexttok.line);
         p->adopt(i);
         return implementation(i);
     } else if (peek(FUNCTION) || peek(CONSTRUCTOR)) {
         insert_derivation({"FUNCDEF"});
-        auto f = new AST(ASTType::FUNCDEF, nexttok.line);
+        auto f = make<AST>(ASTType::FUNCDEF, nexttok.line);
         p->adopt(f);
         return funcdef(f);
     } else if (peek(EOF_TOKEN)) {
@@ -264,38 +391,32 @@ bool Parser::block(AST *p) {
 
 bool Parser::classdef(AST *c) {
     insert_derivation({"class", "id", "ISA", "{", "VISMEMBERDECL", "}", ";"});
-    auto i = new AST(ASTType::ISA, nexttok.line);
-    auto id = new AST(ASTType::ID, nexttok.line);
-    auto m = new AST(ASTType::MEMBERS, nexttok.line);
+    auto i = make<AST>(ASTType::ISA, nexttok.line);
+    auto id = make<AST>(ASTType::ID, nexttok.line);
+    auto m = make<AST>(ASTType::MEMBERS, nexttok.line);
 
     if (expect(CLASS) & identifier(id) & isa(i) & expect(LBRACE) & vismemberdecl(m) &
         expect(RBRACE) & expect(SEMICOLON)) {
         c->adopt({id, i, m});
         return true;
     } else {
-        delete i;
-        delete id;
-        delete m;
         return false;
     }
 }
 
 bool Parser::vismemberdecl(AST *members) {
-    if (!skipErrors({PUBLIC, PRIVATE, EPSILON}, {RBRACE})) return false;
+    if (!skipErrors(first::VISMEMBERDECL, follow::VISMEMBERDECL)) return false;
 
     if (peek(PUBLIC) || peek(PRIVATE)) {
         insert_derivation({"VISIBILITY", "MEMBERDECL", "VISMEMBERDECL"});
-        auto vismem = new AST(ASTType::CLASSMEM, nexttok.line);
-        auto v = new AST(ASTType::VISIBILITY, nexttok.line);
-        auto mem = new AST(nexttok.line);
+        auto vismem = make<AST>(ASTType::CLASSMEM, nexttok.line);
+        auto v = make<AST>(ASTType::VISIBILITY, nexttok.line);
+        auto mem = make<AST>(nexttok.line);
         vismem->adopt({v, mem});
         members->adopt(vismem);
         if (visibility(v) & memdecl(mem) & vismemberdecl(members)) {
             return true;
         }
-        delete vismem;
-        delete v;
-        delete mem;
         return false;
     } else if (peek(RBRACE)) {
         accept_epsilon();
@@ -328,11 +449,11 @@ bool Parser::memdecl(AST *mem) {
 }
 
 bool Parser::isa(AST *i) {
-    if (!skipErrors({ISA, EPSILON}, {LBRACE})) return false;
+    if (!skipErrors(first::ISA, follow::ISA)) return false;
 
     if (peek(ISA)) {
         insert_derivation({"isa", "id", "REPTISA"});
-        auto id = new AST(ASTType::ID, nexttok.line);
+        auto id = make<AST>(ASTType::ID, nexttok.line);
         if (expect(ISA) & identifier(id) & reptisa(id)) {
             i->adopt(id);
             return true;
@@ -349,11 +470,11 @@ bool Parser::isa(AST *i) {
 }
 
 bool Parser::reptisa(AST *id) {
-    if (!skipErrors({COMMA, EPSILON}, {LBRACE})) return false;
+    if (!skipErrors(first::REPTISA, follow::REPTISA)) return false;
 
     if (peek(COMMA)) {
         insert_derivation({",", "id", "REPTISA"});
-        auto id2 = new AST(ASTType::ID, nexttok.line);
+        auto id2 = make<AST>(ASTType::ID, nexttok.line);
         if (expect(COMMA) & identifier(id2) & reptisa(id2)) {
             id->addSibling(id2);
             return true;
@@ -369,8 +490,8 @@ bool Parser::reptisa(AST *id) {
 
 bool Parser::implementation(AST *i) {
     insert_derivation({"implementation", "id", "{", "IMPLBODY", "}"});
-    auto id = new AST(ASTType::ID, nexttok.line);
-    auto body = new AST(ASTType::IMPLBODY, nexttok.line);
+    auto id = make<AST>(ASTType::ID, nexttok.line);
+    auto body = make<AST>(ASTType::IMPLBODY, nexttok.line);
 
     if (expect(IMPLEMENTATION) & identifier(id) & expect(LBRACE) & implbody(body) &
         expect(RBRACE)) {
@@ -382,11 +503,11 @@ bool Parser::implementation(AST *i) {
 }
 
 bool Parser::implbody(AST *body) {
-    if (!skipErrors({FUNCTION, CONSTRUCTOR, EPSILON}, {RBRACE})) return false;
+    if (!skipErrors(first::IMPLBODY, follow::IMPLBODY)) return false;
 
-    if (token_in({FUNCTION, CONSTRUCTOR})) {
+    if (token_in(first::FUNCDEF)) {
         insert_derivation({"FUNCDEF", "IMPLBODY"});
-        auto fdef = new AST(ASTType::FUNCDEF, nexttok.line);
+        auto fdef = make<AST>(ASTType::FUNCDEF, nexttok.line);
 
         body->adopt(fdef);
         if (funcdef(fdef) & implbody(body)) {
@@ -404,15 +525,13 @@ bool Parser::implbody(AST *body) {
 bool Parser::funcdef(AST *fdef) {
     if (peek(FUNCTION) || peek(CONSTRUCTOR)) {
         insert_derivation({"FUNCHEAD", "FUNCBODY"});
-        auto head = new AST(nexttok.line);
-        auto body = new AST(ASTType::FUNCBODY, nexttok.line);
+        auto head = make<AST>(nexttok.line);
+        auto body = make<AST>(ASTType::FUNCBODY, nexttok.line);
 
         if (funchead(head) & funcbody(body)) {
             fdef->adopt({head, body});
             return true;
         }
-        delete head;
-        delete body;
         return false;
     } else {
         error("function or constructor");
@@ -422,7 +541,7 @@ bool Parser::funcdef(AST *fdef) {
 
 bool Parser::visibility(AST *v) {
     if (match(PUBLIC) || match(PRIVATE)) {
-        v->str_value = curtok.value;
+        v->str_value = Name(curtok.value);
         return true;
     }
     error("visibility");
@@ -433,23 +552,20 @@ bool Parser::funchead(AST *f) {
     if (peek(FUNCTION)) {
         insert_derivation({"function", "id", "(", "FPARAMS", ")", "=>", "RETURNTYPE"});
         f->type = ASTType::FUNCHEAD;
-        auto id = new AST(ASTType::ID, nexttok.line);
-        auto params = new AST(ASTType::FPARAMS, nexttok.line);
-        auto rtype = new AST(ASTType::TYPE, nexttok.line);
+        auto id = make<AST>(ASTType::ID, nexttok.line);
+        auto params = make<AST>(ASTType::FPARAMS, nexttok.line);
+        auto rtype = make<AST>(ASTType::TYPE, nexttok.line);
 
         if (expect(FUNCTION) & identifier(id) & expect(LPAREN) & fparams(params) &
             expect(RPAREN) & expect(ARROW) & returntype(rtype)) {
             f->adopt({id, params, rtype});
             return true;
         }
-        delete id;
-        delete params;
-        delete rtype;
         return false;
     } else if (peek(CONSTRUCTOR)) {
         insert_derivation({"constructor", "(", "FPARAMS", ")"});
         f->type = ASTType::CONSTRUCTOR;
-        auto params = new AST(ASTType::FPARAMS, nexttok.line);
+        auto params = make<AST>(ASTType::FPARAMS, nexttok.line);
 
         if (expect(CONSTRUCTOR) & expect(LPAREN) & fparams(params) & expect(RPAREN)) {
             f->adopt(params);
@@ -470,16 +586,15 @@ bool Parser::funcbody(AST *body) {
 
 bool Parser::reptfuncbody(AST *body) {
     // statement_starters or local or id
-    if (!skipErrors({LOCAL, IDENTIFIER, SELF, IF, WHILE, READ, WRITE, RETURN, EPSILON}, {RBRACE})) return false;
+    if (!skipErrors(first::REPTFUNCBODY, follow::REPTFUNCBODY)) return false;
 
     if (peek(LOCAL) || isStatement()) {
         insert_derivation({"LOCALVARDECLORSTAT", "REPTFUNCBODY"});
-        auto declorstat = new AST(nexttok.line);
+        auto declorstat = make<AST>(nexttok.line);
         body->adopt(declorstat);
         if (localvardeclorstat(declorstat) & reptfuncbody(body)) {
             return true;
         }
-        delete declorstat;
         return false;
     }
     if (peek(RBRACE)) {
@@ -529,18 +644,15 @@ bool Parser::localvardecl(AST *decl) {
 }
 
 bool Parser::vardecl(AST *decl) {
-    if (!skipErrors({IDENTIFIER})) return false;
+    if (!skipErrors(first::VARDECL, {})) return false;
     insert_derivation({"id", ":", "TYPE", "ARRAYSIZES", ";"});
-    auto id = new AST(ASTType::ID, nexttok.line);
-    auto t = new AST(ASTType::TYPE, nexttok.line);
-    auto as = new AST(ASTType::ARRAYSIZES, nexttok.line);
+    auto id = make<AST>(ASTType::ID, nexttok.line);
+    auto t = make<AST>(ASTType::TYPE, nexttok.line);
+    auto as = make<AST>(ASTType::ARRAYSIZES, nexttok.line);
     if (identifier(id) & expect(COLON) & type(t) & arraysizes(as) & expect(SEMICOLON)) {
         decl->adopt({id, t, as});
         return true;
     }
-    delete id;
-    delete t;
-    delete as;
     accept_epsilon();
     return false;
 }
@@ -553,39 +665,37 @@ bool Parser::statement(AST *s) {
             s->adopt(f);
             return true;
         }
-        delete f;
         return false;
     } else if (peek(IF)) {
         insert_derivation({"if", "(", "RELEXPR", ")", "then", "STATBLOCK", "else", "STATBLOCK", ";"});
-        auto r = new AST(ASTType::RELOP, nexttok.line);
-        auto s1 = new AST(ASTType::STATBLOCK, nexttok.line);
-        auto s2 = new AST(ASTType::STATBLOCK, nexttok.line);
+        auto r = make<AST>(ASTType::RELOP, nexttok.line);
+        auto s1 = make<AST>(ASTType::STATBLOCK, nexttok.line);
+        auto s2 = make<AST>(ASTType::STATBLOCK, nexttok.line);
         if (expect(IF) & expect(LPAREN) & relexpr(r) & expect(RPAREN) & expect(THEN) &
             statblock(s1) & expect(ELSE) & statblock(s2) & expect(SEMICOLON)) {
-            auto i = new AST(ASTType::IF, nexttok.line, {r, s1, s2});
+            auto i = make<AST>(ASTType::IF, nexttok.line);
+            i->adopt({r, s1, s2});
             s->adopt(i);
             return true;
         }
-        delete r;
-        delete s1;
-        delete s2;
         return false;
     } else if (peek(WHILE)) {
         insert_derivation({"while", "(", "RELEXPR", ")", "STATBLOCK", ";"});
-        auto r = new AST(ASTType::RELOP, nexttok.line);
-        auto sb = new AST(ASTType::STATBLOCK, nexttok.line);
+        auto r = make<AST>(ASTType::RELOP, nexttok.line);
+        auto sb = make<AST>(ASTType::STATBLOCK, nexttok.line);
 
         if (expect(WHILE) & expect(LPAREN) & relexpr(r) & expect(RPAREN) &
             statblock(sb) & expect(SEMICOLON)) {
-            auto w = new AST(ASTType::WHILE, nexttok.line, {r, sb});
+            auto w = make<AST>(ASTType::WHILE, nexttok.line);
+            w->adopt({r, sb});
             s->adopt(w);
             return true;
         }
         return false;
     } else if (peek(READ)) {
         insert_derivation({"read", "(", "VARIABLE", ")", ";"});
-        auto r = new AST(ASTType::READ, nexttok.line);
-        auto v = new AST(ASTType::VARIABLE, nexttok.line);
+        auto r = make<AST>(ASTType::READ, nexttok.line);
+        auto v = make<AST>(ASTType::VARIABLE, nexttok.line);
 
         if (expect(READ) & expect(LPAREN) & variable(v) & expect(RPAREN) &
             expect(SEMICOLON)) {
@@ -593,12 +703,11 @@ bool Parser::statement(AST *s) {
             s->adopt(r);
             return true;
         }
-        delete v;
         return false;
     } else if (peek(WRITE)) {
         insert_derivation({"write", "(", "EXPR", ")", ";"});
-        auto w = new AST(ASTType::WRITE, nexttok.line);
-        auto e = new AST(ASTType::EXPR, nexttok.line);
+        auto w = make<AST>(ASTType::WRITE, nexttok.line);
+        auto e = make<AST>(ASTType::EXPR, nexttok.line);
         if (expect(WRITE) & expect(LPAREN) & expr(e) & expect(RPAREN) &
             expect(SEMICOLON)) {
             w->adopt(e);
@@ -608,8 +717,8 @@ bool Parser::statement(AST *s) {
         return false;
     } else if (peek(RETURN)) {
         insert_derivation({"return", "(", "EXPR", ")", ";"});
-        auto r = new AST(ASTType::RETURN, nexttok.line);
-        auto e = new AST(ASTType::EXPR, nexttok.line);
+        auto r = make<AST>(ASTType::RETURN, nexttok.line);
+        auto e = make<AST>(ASTType::EXPR, nexttok.line);
 
         if (expect(RETURN) & expect(LPAREN) & expr(e) & expect(RPAREN) &
             expect(SEMICOLON)) {
@@ -627,11 +736,10 @@ bool Parser::statement(AST *s) {
 bool Parser::funcallorassign(AST **f) {
     if (peek(IDENTIFIER) || peek(SELF)) {
         insert_derivation({"IDORSELF", "FUNCALLORASSIGN2"});
-        auto id = new AST(nexttok.line); // Type to be decided by IDORSELF
+        auto id = make<AST>(nexttok.line); // Type to be decided by IDORSELF
         if (idorself(id) & funcallorassign2(id, f)) {
             return true;
         }
-        delete id;
         return false;
     }
     error("id or self");
@@ -641,25 +749,22 @@ bool Parser::funcallorassign(AST **f) {
 bool Parser::funcallorassign2(AST *left, AST **right) {
     if (peek(LPAREN)) {
         insert_derivation({"(", "APARAMS", ")", "FUNCALLORASSIGN4"});
-        auto f = new AST(ASTType::FUNCALL, nexttok.line);
-        auto a = new AST(ASTType::APARAMS, nexttok.line);
+        auto f = make<AST>(ASTType::FUNCALL, nexttok.line);
+        auto a = make<AST>(ASTType::APARAMS, nexttok.line);
         f->adopt({left, a});
         if (expect(LPAREN) & aparams(a) & expect(RPAREN) & funcallorassign4(f, right)) {
             return true;
         }
-        delete f;
-        delete a;
         return false;
     }
     if (peek(LBRACKET) || peek(DOT) || peek(ASSIGN)) {
         insert_derivation({"INDICES", "FUNCALLORASSIGN3"});
-        auto i = new AST(ASTType::INDICES, nexttok.line);
-        auto v = new AST(ASTType::DATAMEMBER, nexttok.line);
+        auto i = make<AST>(ASTType::INDICES, nexttok.line);
+        auto v = make<AST>(ASTType::DATAMEMBER, nexttok.line);
         v->adopt({left, i});
         if (indices(i) & funcallorassign3(v, right)) {
             return true;
         }
-        delete i;
         return false;
     }
     error("'(', '[', '.', or ':='");
@@ -669,21 +774,19 @@ bool Parser::funcallorassign2(AST *left, AST **right) {
 bool Parser::funcallorassign3(AST *left, AST **right) {
     if (peek(ASSIGN)) {
         insert_derivation({":=", "EXPR"});
-        auto a = new AST(ASTType::ASSIGN, nexttok.line);
-        auto e = new AST(ASTType::EXPR, nexttok.line);
+        auto a = make<AST>(ASTType::ASSIGN, nexttok.line);
+        auto e = make<AST>(ASTType::EXPR, nexttok.line);
         a->adopt({left, e});
         if (expect(ASSIGN) & expr(e)) {
             *right = a;
             return true;
         }
-        delete a;
-        delete e;
         return false;
     }
     if (peek(DOT)) {
         insert_derivation({".", "id", "FUNCALLORASSIGN2"});
-        auto d = new AST(ASTType::DOT, nexttok.line);
-        auto id = new AST(ASTType::ID, nexttok.line);
+        auto d = make<AST>(ASTType::DOT, nexttok.line);
+        auto id = make<AST>(ASTType::ID, nexttok.line);
         d->adopt({left, id});
         return expect(DOT) & identifier(id) & funcallorassign2(d, right);
     }
@@ -692,20 +795,18 @@ bool Parser::funcallorassign3(AST *left, AST **right) {
 }
 
 bool Parser::funcallorassign4(AST *l, AST **r) {
-    if (!skipErrors({DOT, EPSILON}, {SEMICOLON})) return false;
+    if (!skipErrors(first::FUNCALLORASSIGN4, follow::FUNCALLORASSIGN4)) return false;
 
     if (peek(DOT)) {
         insert_derivation({".", "id", "FUNCALLORASSIGN2"});
-        auto d = new AST(ASTType::DOT, nexttok.line);
-        auto id = new AST(ASTType::ID, nexttok.line);
+        auto d = make<AST>(ASTType::DOT, nexttok.line);
+        auto id = make<AST>(ASTType::ID, nexttok.line);
         d->adopt({l, id});
-        auto r1 = new AST(nexttok.line);
+        auto r1 = make<AST>(nexttok.line);
         if (expect(DOT) & identifier(id) & funcallorassign2(d, &r1)) {
             *r = r1;
             return true;
         }
-        delete d;
-        delete id;
         return false;
     }
     if (peek(SEMICOLON)) {
@@ -719,27 +820,24 @@ bool Parser::funcallorassign4(AST *l, AST **r) {
 }
 
 bool Parser::statblock(AST *sb) {
-    if (!skipErrors({LBRACE, IF, WHILE, READ, WRITE, RETURN, IDENTIFIER, SELF, EPSILON}, {ELSE, SEMICOLON})) return
-            false;
+    if (!skipErrors(first::STATBLOCK, follow::STATBLOCK)) return false;
 
     if (peek(LBRACE)) {
         insert_derivation({"{", "STATEMENTS", "}"});
-        auto stmts = new AST(ASTType::STATEMENTS, nexttok.line);
+        auto stmts = make<AST>(ASTType::STATEMENTS, nexttok.line);
         if (expect(LBRACE) & statements(stmts) & expect(RBRACE)) {
             sb->adopt(stmts);
             return true;
         }
-        delete stmts;
         return false;
     }
     if (isStatement()) {
         insert_derivation({"STATEMENT"});
-        auto s = new AST(ASTType::STATEMENT, nexttok.line);
+        auto s = make<AST>(ASTType::STATEMENT, nexttok.line);
         if (statement(s)) {
             sb->adopt(s);
             return true;
         }
-        delete s;
         return false;
     }
     if (peek(ELSE) || peek(SEMICOLON)) {
@@ -752,16 +850,15 @@ bool Parser::statblock(AST *sb) {
 
 bool Parser::statements(AST *stmts) {
     assert(stmts != nullptr);
-    if (!skipErrors({IF, WHILE, READ, WRITE, RETURN, IDENTIFIER, SELF, EPSILON}, {RBRACE})) return false;
+    if (!skipErrors(first::STATEMENTS, follow::STATEMENTS)) return false;
 
     if (isStatement()) {
         insert_derivation({"STATEMENT", "STATEMENTS"});
-        auto s = new AST(ASTType::STATEMENT, nexttok.line);
+        auto s = make<AST>(ASTType::STATEMENT, nexttok.line);
         stmts->adopt(s);
         if (statement(s) & statements(stmts)) {
             return true;
         }
-        delete s;
         return false;
     } else if (peek(RBRACE)) {
         accept_epsilon();
@@ -783,22 +880,19 @@ bool Parser::expr(AST *e) {
 }
 
 bool Parser::exprtail(AST *left, AST **right) {
-    tokentype_set follow = {RPAREN, SEMICOLON, COMMA};
-    if (!skipErrors({EQ, NEQ, LT, GT, LTEQ, GTEQ, EPSILON}, follow)) return false;
+    if (!skipErrors(first::EXPR2, follow::EXPR2)) return false;
 
     if (isRelop()) {
         insert_derivation({"RELOP", "ARITHEXPR"});
-        auto r = new AST(ASTType::RELOP, nexttok.line);
+        auto r = make<AST>(ASTType::RELOP, nexttok.line);
         AST *a = nullptr;
         if (relop(r) & arithexpr(&a)) {
             r->adopt({left, a});
             *right = r;
             return true;
         }
-        delete r;
-        delete a;
         return false;
-    } else if (token_in(follow)) {
+    } else if (token_in(follow::EXPR2)) {
         accept_epsilon();
         *right = left;
         return true;
@@ -816,8 +910,6 @@ bool Parser::relexpr(AST *rel) {
         rel->adopt({a1, a2});
         return true;
     }
-    delete a1;
-    delete a2;
     return false;
 }
 
@@ -830,13 +922,12 @@ bool Parser::arithexpr(AST **a) {
 }
 
 bool Parser::rightrecarithexpr(AST *left, AST **right) {
-    tokentype_set follow = {RPAREN, SEMICOLON, COMMA, EQ, GT, GTEQ, LT, LTEQ, NEQ, RBRACKET};
-    if (!skipErrors({ADD, SUB, OR, EPSILON}, follow)) return false;
+    if (!skipErrors(first::RIGHTRECARITHEXPR, follow::RIGHTRECARITHEXPR)) return false;
 
     if (isAddop()) {
         insert_derivation({"ADDOP", "TERM", "RIGHTRECARITHEXPR"});
         bool success = true;
-        auto a = new AST(ASTType::ADDOP, nexttok.line);
+        auto a = make<AST>(ASTType::ADDOP, nexttok.line);
         AST *t;
         if (!(addop(a) & term(&t))) success = false;
         a->adopt({left, t});
@@ -845,9 +936,8 @@ bool Parser::rightrecarithexpr(AST *left, AST **right) {
         if (success) {
             return true;
         }
-        delete a;
         return false;
-    } else if (token_in(follow)) {
+    } else if (token_in(follow::RIGHTRECARITHEXPR)) {
         accept_epsilon();
         *right = left;
         return true;
@@ -859,7 +949,7 @@ bool Parser::rightrecarithexpr(AST *left, AST **right) {
 
 bool Parser::sign(AST *s) {
     if (match(ADD) || match(SUB)) {
-        s->str_value = curtok.value;
+        s->str_value = Name(curtok.value);
         return true;
     }
     error("sign");
@@ -876,14 +966,12 @@ bool Parser::term(AST **t) {
 }
 
 bool Parser::rightrecterm(AST *left, AST **right) {
-    if (!skipErrors({MUL, DIV, AND, EPSILON}, {
-                        RPAREN, SEMICOLON, COMMA, EQ, GT, GTEQ, LT, LTEQ, NEQ, RBRACKET, SUB, ADD, OR
-                    })) return false;
+    if (!skipErrors(first::RIGHTRECTERM, follow::RIGHTRECTERM)) return false;
 
     if (isMultop()) {
         insert_derivation({"MULTOP", "FACTOR", "RIGHTRECTERM"});
         bool success = true;
-        auto m = new AST(ASTType::MULTOP, nexttok.line);
+        auto m = make<AST>(ASTType::MULTOP, nexttok.line);
         AST *f;
         if (!(multop(m) & factor(&f))) success = false;
         m->adopt({left, f});
@@ -892,10 +980,8 @@ bool Parser::rightrecterm(AST *left, AST **right) {
         if (success) {
             return true;
         }
-        delete m;
-        delete f;
         return false;
-    } else if (token_in_values({")", ";", ",", "==", ">", ">=", "<", "<=", "<>", "]", "+", "-", "or"})) {
+    } else if (token_in(follow::RIGHTRECTERM)) {
         accept_epsilon();
         *right = left;
         return true;
@@ -908,22 +994,20 @@ bool Parser::rightrecterm(AST *left, AST **right) {
 bool Parser::factor(AST **f) {
     if (peek(INTLIT)) {
         insert_derivation({"intlit"});
-        auto il = new ASTIntLit(nexttok.line);
+        auto il = make<ASTIntLit>(nexttok.line);
         if (intlit(il)) {
             *f = il;
             return true;
         }
-        delete il;
         return false;
     }
     if (peek(FLOATLIT)) {
         insert_derivation({"floatlit"});
-        auto fl = new ASTFloatLit(nexttok.line);
+        auto fl = make<ASTFloatLit>(nexttok.line);
         if (floatlit(fl)) {
             *f = fl;
             return true;
         }
-        delete fl;
         return false;
     }
     if (peek(LPAREN)) {
@@ -935,30 +1019,27 @@ bool Parser::factor(AST **f) {
     }
     if (peek(ADD) || peek(SUB)) {
         insert_derivation({"SIGN", "FACTOR"});
-        auto s = new AST(ASTType::SIGN, nexttok.line);
+        auto s = make<AST>(ASTType::SIGN, nexttok.line);
         AST *f2;
         if (sign(s) & factor(&f2)) {
             *f = s->adopt(f2);
             return true;
         }
-        delete s;
-        delete f2;
         return false;
     }
     if (peek(NOT)) {
         insert_derivation({"not", "FACTOR"});
-        auto n = new AST(ASTType::NOT, nexttok.line);
+        auto n = make<AST>(ASTType::NOT, nexttok.line);
         AST *f2;
         if (expect(NOT) & factor(&f2)) {
             *f = n->adopt(f2);
             return true;
         }
-        delete n;
         return false;
     }
     if (peek(IDENTIFIER) || peek(SELF)) {
         insert_derivation({"IDORSELF", "FACTOR2", "REPTIDNEST"});
-        auto id = new AST(ASTType::ID, nexttok.line);
+        auto id = make<AST>(ASTType::ID, nexttok.line);
         AST *result = nullptr;
         AST *result2 = nullptr;
         if (idorself(id) & factor2(id, &result) & reptidnest(result, &result2)) {
@@ -974,27 +1055,22 @@ bool Parser::factor(AST **f) {
 }
 
 bool Parser::factor2(AST *left, AST **right) {
-    if (!skipErrors({LPAREN, LBRACKET, EPSILON}, {
-                        RPAREN, SEMICOLON, COMMA, EQ, GT, GTEQ, LT, LTEQ, NEQ, RBRACKET, ADD, SUB, OR, MUL, DIV, AND,
-                        DOT
-                    })) return false;
+    if (!skipErrors(first::FACTOR2, follow::FACTOR2)) return false;
 
     if (peek(LPAREN)) {
         insert_derivation({"(", "APARAMS", ")"});
-        auto f = new AST(ASTType::FUNCALL, nexttok.line);
-        auto a = new AST(ASTType::APARAMS, nexttok.line);
+        auto f = make<AST>(ASTType::FUNCALL, nexttok.line);
+        auto a = make<AST>(ASTType::APARAMS, nexttok.line);
         if (expect(LPAREN) & aparams(a) & expect(RPAREN)) {
             f->adopt({left, a});
             *right = f;
             return true;
         }
-        delete f;
-        delete a;
         return false;
     } else {
         insert_derivation({"INDICES"});
-        auto d = new AST(ASTType::DATAMEMBER, nexttok.line);
-        auto i = new AST(ASTType::INDICES, nexttok.line);
+        auto d = make<AST>(ASTType::DATAMEMBER, nexttok.line);
+        auto i = make<AST>(ASTType::INDICES, nexttok.line);
         d->adopt({left, i});
         if (indices(i)) {
             *right = d;
@@ -1005,10 +1081,7 @@ bool Parser::factor2(AST *left, AST **right) {
 }
 
 bool Parser::indices(AST *i) {
-    tokentype_set follow = {
-        DOT, ASSIGN, RPAREN, SEMICOLON, COMMA, EQ, GT, GTEQ, LT, LTEQ, NEQ, RBRACKET, ADD, SUB, OR, MUL, DIV, AND
-    };
-    if (!skipErrors({LBRACKET, EPSILON}, follow)) return false;
+    if (!skipErrors(first::INDICES, follow::INDICES)) return false;
 
     if (peek(LBRACKET)) {
         insert_derivation({"INDICE", "INDICES"});
@@ -1019,12 +1092,11 @@ bool Parser::indices(AST *i) {
         if (!indices(i)) success = false;
 
         if (!success) {
-            delete ind;
             return false;
         }
         return true;
     }
-    if (token_in(follow)) {
+    if (token_in(follow::INDICES)) {
         accept_epsilon();
         return true;
     }
@@ -1034,16 +1106,14 @@ bool Parser::indices(AST *i) {
 }
 
 bool Parser::reptidnest(AST *left, AST **right) {
-    if (!skipErrors({DOT, EPSILON}, {
-                        RPAREN, SEMICOLON, COMMA, EQ, GT, GTEQ, LT, LTEQ, NEQ, RBRACKET, ADD, SUB, OR, MUL, DIV, AND
-                    })) return false;
+    if (!skipErrors(first::REPTIDNEST, follow::REPTIDNEST)) return false;
 
     if (peek(DOT)) {
         insert_derivation({"IDNEST", "REPTIDNEST"});
         AST *result;
         return idnest(left, &result) & reptidnest(result, right);
     }
-    if (token_in_values({")", ";", ",", "==", ">", ">=", "<", "<=", "<>", "]", "+", "-", "or", "and", "*", "/"})) {
+    if (token_in(follow::REPTIDNEST)) {
         *right = left;
         accept_epsilon();
         return true;
@@ -1054,24 +1124,22 @@ bool Parser::reptidnest(AST *left, AST **right) {
 
 bool Parser::variable(AST *v) {
     insert_derivation({"IDORSELF", "VARIABLE2"});
-    auto id = new AST(nexttok.line);
-    auto result = new AST(nexttok.line);
+    auto id = make<AST>(nexttok.line);
+    auto result = make<AST>(nexttok.line);
     if (idorself(id) & variable2(id, &result)) {
         v->adopt(result);
         return true;
     }
-    delete id;
-    delete result;
     return false;
 }
 
 bool Parser::variable2(AST *left, AST **var) {
-    if (!skipErrors({LPAREN, LBRACKET, DOT, EPSILON}, {RPAREN})) return false;
+    if (!skipErrors(first::VARIABLE2, follow::VARIABLE2)) return false;
 
     if (peek(LPAREN)) {
         insert_derivation({"(", "APARAMS", ")", "VARIDNEST"});
-        auto f = new AST(ASTType::FUNCALL, nexttok.line);
-        auto a = new AST(ASTType::APARAMS, nexttok.line);
+        auto f = make<AST>(ASTType::FUNCALL, nexttok.line);
+        auto a = make<AST>(ASTType::APARAMS, nexttok.line);
         f->adopt({left, a});
         AST *result;
 
@@ -1084,20 +1152,19 @@ bool Parser::variable2(AST *left, AST **var) {
     }
     if (peek(LBRACKET) || peek(DOT)) {
         insert_derivation({"INDICES", "REPTVARIABLE"});
-        auto d = new AST(ASTType::DATAMEMBER, nexttok.line);
-        auto i = new AST(ASTType::INDICES, nexttok.line);
+        auto d = make<AST>(ASTType::DATAMEMBER, nexttok.line);
+        auto i = make<AST>(ASTType::INDICES, nexttok.line);
         d->adopt({left, i});
         AST *result;
         if (indices(i) & reptvariable(d, &result)) {
             *var = result;
             return true;
         }
-        delete i;
         return false;
     }
-    if (token_in({RPAREN})) {
-        auto d = new AST(ASTType::DATAMEMBER, nexttok.line);
-        auto i = new AST(ASTType::INDICES, nexttok.line);
+    if (token_in(follow::VARIABLE2)) {
+        auto d = make<AST>(ASTType::DATAMEMBER, nexttok.line);
+        auto i = make<AST>(ASTType::INDICES, nexttok.line);
         d->adopt({left, i});
         *var = d;
         accept_epsilon();
@@ -1108,14 +1175,14 @@ bool Parser::variable2(AST *left, AST **var) {
 }
 
 bool Parser::reptvariable(AST *left, AST **var) {
-    if (!skipErrors({DOT, EPSILON}, {RPAREN})) return false;
+    if (!skipErrors(first::REPTVARIABLE, follow::REPTVARIABLE)) return false;
 
     if (peek(DOT)) {
         insert_derivation({"VARIDNEST", "REPTVARIABLE"});
         AST *result = nullptr;
         return varidnest(left, &result) & reptvariable(result, var);
     }
-    if (token_in({RPAREN})) {
+    if (token_in(follow::REPTVARIABLE)) {
         *var = left;
         accept_epsilon();
         return true;
@@ -1127,8 +1194,8 @@ bool Parser::reptvariable(AST *left, AST **var) {
 bool Parser::varidnest(AST *left, AST **result) {
     if (peek(DOT)) {
         insert_derivation({".", "id", "VARIDNESTTAIL"});
-        auto d = new AST(ASTType::DOT, nexttok.line);
-        auto id = new AST(ASTType::ID, nexttok.line);
+        auto d = make<AST>(ASTType::DOT, nexttok.line);
+        auto id = make<AST>(ASTType::ID, nexttok.line);
         d->adopt({left, id});
         return expect(DOT) & identifier(id) & varidnesttail(d, result);
     } else {
@@ -1138,30 +1205,27 @@ bool Parser::varidnest(AST *left, AST **result) {
 }
 
 bool Parser::varidnesttail(AST *left, AST **result) {
-    if (!skipErrors({LPAREN, LBRACKET, EPSILON}, {RPAREN, DOT})) return false;
+    if (!skipErrors(first::VARIDNESTTAIL, follow::VARIDNESTTAIL)) return false;
 
     if (peek(LPAREN)) {
         insert_derivation({"(", "APARAMS", ")", "VARIDNEST"});
-        auto f = new AST(ASTType::FUNCALL, nexttok.line);
-        auto a = new AST(ASTType::APARAMS, nexttok.line);
+        auto f = make<AST>(ASTType::FUNCALL, nexttok.line);
+        auto a = make<AST>(ASTType::APARAMS, nexttok.line);
         f->adopt({left, a});
         if (expect(LPAREN) & aparams(a) & expect(RPAREN) & varidnest(f, result)) {
             return true;
         }
-        delete f;
-        delete a;
         return false;
     } else {
         insert_derivation({"INDICES"});
-        auto d = new AST(ASTType::DATAMEMBER, nexttok.line);
-        auto i = new AST(ASTType::INDICES, nexttok.line);
+        auto d = make<AST>(ASTType::DATAMEMBER, nexttok.line);
+        auto i = make<AST>(ASTType::INDICES, nexttok.line);
         d->adopt({left, i});
 
         if (indices(i)) {
             *result = d;
             return true;
         }
-        delete d;
         return false;
     }
 }
@@ -1176,46 +1240,37 @@ bool Parser::indice(AST **i) {
 
 bool Parser::idnest(AST *left, AST **right) {
     insert_derivation({".", "id", "IDNESTTAIL"});
-    auto d = new AST(ASTType::DOT, nexttok.line);
-    auto id = new AST(ASTType::ID, nexttok.line);
+    auto d = make<AST>(ASTType::DOT, nexttok.line);
+    auto id = make<AST>(ASTType::ID, nexttok.line);
     d->adopt({left, id});
     if (expect(DOT) & identifier(id) & idnesttail(d, right)) {
         return true;
     }
-    delete d;
-    delete id;
     return false;
 }
 
 bool Parser::idnesttail(AST *left, AST **right) {
-    if (!skipErrors({LPAREN, LBRACKET, EPSILON}, {
-                        DOT, RPAREN, SEMICOLON, COMMA, EQ, GT, GTEQ, LT, LTEQ, NEQ, RBRACKET, ADD, SUB, OR, MUL, DIV,
-                        AND
-                    })) return false;
+    if (!skipErrors(first::IDNESTTAIL, follow::IDNESTTAIL)) return false;
 
     if (peek(LPAREN)) {
         insert_derivation({"(", "APARAMS", ")"});
-        auto f = new AST(ASTType::FUNCALL, nexttok.line);
-        auto a = new AST(ASTType::APARAMS, nexttok.line);
+        auto f = make<AST>(ASTType::FUNCALL, nexttok.line);
+        auto a = make<AST>(ASTType::APARAMS, nexttok.line);
         if (expect(LPAREN) & aparams(a) & expect(RPAREN)) {
             f->adopt({left, a});
             *right = f;
             return true;
         }
-        delete f;
-        delete a;
         return false;
     } else {
         insert_derivation({"INDICES"});
-        auto d = new AST(ASTType::DATAMEMBER, nexttok.line);
-        auto i = new AST(ASTType::INDICES, nexttok.line);
+        auto d = make<AST>(ASTType::DATAMEMBER, nexttok.line);
+        auto i = make<AST>(ASTType::INDICES, nexttok.line);
         if (indices(i)) {
             d->adopt({left, i});
             *right = d;
             return true;
         }
-        delete d;
-        delete i;
         return false;
     }
 }
@@ -1228,7 +1283,7 @@ bool Parser::arraysize(AST *size) {
 bool Parser::arraysizetail(AST *size) {
     if (peek(INTLIT)) {
         insert_derivation({"intlit", "]"});
-        auto i = new ASTIntLit(nexttok.line);
+        auto i = make<ASTIntLit>(nexttok.line);
         if (intlit(i) & expect(RBRACKET)) {
             size->adopt(i);
             return true;
@@ -1244,18 +1299,17 @@ bool Parser::arraysizetail(AST *size) {
 }
 
 bool Parser::arraysizes(AST *as) {
-    std::unordered_set<TokenType> follow = {SEMICOLON, RPAREN, COMMA};
-    if (!skipErrors({LBRACKET, EPSILON}, follow)) return false;
+    if (!skipErrors(first::ARRAYSIZES, follow::ARRAYSIZES)) return false;
 
     if (peek(LBRACKET)) {
         insert_derivation({"ARRAYSIZE", "ARRAYSIZES"});
-        auto size = new AST(ASTType::ARRAYSIZE, nexttok.line);
+        auto size = make<AST>(ASTType::ARRAYSIZE, nexttok.line);
         if (arraysize(size) & arraysizes(as)) {
             as->adopt(size);
             return true;
         }
         return false;
-    } else if (token_in(follow)) {
+    } else if (token_in(follow::ARRAYSIZES)) {
         accept_epsilon();
         return true;
     } else {
@@ -1266,7 +1320,7 @@ bool Parser::arraysizes(AST *as) {
 
 bool Parser::type(AST *t) {
     if (match(IDENTIFIER) || match(INT) || match(FLOAT)) {
-        t->str_value = curtok.value;
+        t->str_value = Name(curtok.value);
         return true;
     }
     accept_epsilon();
@@ -1276,7 +1330,7 @@ bool Parser::type(AST *t) {
 
 bool Parser::returntype(AST *t) {
     if (match(VOID)) {
-        t->str_value = curtok.value;
+        t->str_value = Name(curtok.value);
         return true;
     } else {
         return type(t);
@@ -1284,16 +1338,15 @@ bool Parser::returntype(AST *t) {
 }
 
 bool Parser::aparams(AST *params) {
-    if (!skipErrors({INTLIT, FLOATLIT, IDENTIFIER, LPAREN, ADD, SUB, NOT, SELF, EPSILON}, {RPAREN})) return false;
+    if (!skipErrors(first::APARAMS, follow::APARAMS)) return false;
 
     if (isFactor()) {
         insert_derivation({"EXPR", "REPTAPARAMS"});
-        auto e = new AST(ASTType::EXPR, nexttok.line);
+        auto e = make<AST>(ASTType::EXPR, nexttok.line);
         params->adopt(e);
         if (expr(e) & reptaparams(params)) {
             return true;
         }
-        delete e;
         return false;
     } else if (peek(RPAREN)) {
         accept_epsilon();
@@ -1304,16 +1357,15 @@ bool Parser::aparams(AST *params) {
 }
 
 bool Parser::reptaparams(AST *params) {
-    if (!skipErrors({COMMA, EPSILON}, {RPAREN})) return false;
+    if (!skipErrors(first::REPTAPARAMS1, follow::REPTAPARAMS1)) return false;
 
     if (peek(COMMA)) {
         insert_derivation({"APARAMSTAIL", "REPTAPARAMS"});
-        auto e = new AST(ASTType::EXPR, nexttok.line);
+        auto e = make<AST>(ASTType::EXPR, nexttok.line);
         params->adopt(e);
         if (aparamstail(e) & reptaparams(params)) {
             return true;
         }
-        delete e;
         return false;
     } else if (peek(RPAREN)) {
         accept_epsilon();
@@ -1328,13 +1380,13 @@ bool Parser::aparamstail(AST *e) {
 }
 
 bool Parser::fparams(AST *fp) {
-    if (!skipErrors({IDENTIFIER, EPSILON}, {RPAREN})) return false;
+    if (!skipErrors(first::FPARAMS, follow::FPARAMS)) return false;
 
     if (peek(IDENTIFIER)) {
-        auto param = new AST(ASTType::FPARAM, nexttok.line);
-        auto id = new AST(ASTType::ID, nexttok.line);
-        auto t = new AST(ASTType::TYPE, nexttok.line);
-        auto as = new AST(ASTType::ARRAYSIZES, nexttok.line);
+        auto param = make<AST>(ASTType::FPARAM, nexttok.line);
+        auto id = make<AST>(ASTType::ID, nexttok.line);
+        auto t = make<AST>(ASTType::TYPE, nexttok.line);
+        auto as = make<AST>(ASTType::ARRAYSIZES, nexttok.line);
 
         insert_derivation({"id", ":", "TYPE", "ARRAYSIZES", "REPTFPARAMS"});
         fp->adopt(param);
@@ -1352,14 +1404,14 @@ bool Parser::fparams(AST *fp) {
 }
 
 bool Parser::reptfparams(AST *fp) {
-    if (!skipErrors({COMMA, EPSILON}, {RPAREN})) return false;
+    if (!skipErrors(first::REPTFPARAMS1, follow::REPTFPARAMS1)) return false;
 
     if (peek(COMMA)) {
         insert_derivation({",", "id", ":", "TYPE", "ARRAYSIZES", "REPTFPARAMS"});
-        auto param = new AST(ASTType::FPARAM, nexttok.line);
-        auto id = new AST(ASTType::ID, nexttok.line);
-        auto t = new AST(ASTType::TYPE, nexttok.line);
-        auto as = new AST(ASTType::ARRAYSIZES, nexttok.line);
+        auto param = make<AST>(ASTType::FPARAM, nexttok.line);
+        auto id = make<AST>(ASTType::ID, nexttok.line);
+        auto t = make<AST>(ASTType::TYPE, nexttok.line);
+        auto as = make<AST>(ASTType::ARRAYSIZES, nexttok.line);
         fp->adopt(param);
         if (expect(COMMA) & identifier(id) & expect(COLON) & type(t) & arraysizes(as) & reptfparams(fp)) {
             param->adopt({id, t, as});
@@ -1378,7 +1430,7 @@ bool Parser::relop(AST *r) {
     assert(r != nullptr);
     if (match(EQ) || match(NEQ) || match(LT) || match(GT) ||
         match(LTEQ) || match(GTEQ)) {
-        r->str_value = curtok.value;
+        r->str_value = Name(curtok.value);
         r->line_number = curtok.line;
         return true;
     }
@@ -1389,7 +1441,7 @@ bool Parser::relop(AST *r) {
 bool Parser::addop(AST *a) {
     assert(a != nullptr);
     if (match(ADD) || match(SUB) || match(OR)) {
-        a->str_value = curtok.value;
+        a->str_value = Name(curtok.value);
         return true;
     }
     error("addop");
@@ -1399,7 +1451,7 @@ bool Parser::addop(AST *a) {
 bool Parser::multop(AST *m) {
     assert(m != nullptr);
     if (match(MUL) || match(DIV) || match(AND)) {
-        m->str_value = curtok.value;
+        m->str_value = Name(curtok.value);
         return true;
     }
     error("multop");
@@ -1424,7 +1476,9 @@ bool Parser::intlit(ASTIntLit *i) {
         accept_epsilon();
         return false;
     }
-    i->value = std::stoi(curtok.value);
+    if (std::from_chars(curtok.value.data(), curtok.value.data() + curtok.value.size(), i->value).ec != std::errc()) {
+        literal_error("Integer");
+    }
     return true;
 }
 
@@ -1433,35 +1487,37 @@ bool Parser::floatlit(ASTFloatLit *f) {
         accept_epsilon();
         return false;
     }
-    f->value = std::stof(curtok.value);
+    if (std::from_chars(curtok.value.data(), curtok.value.data() + curtok.value.size(), f->value).ec != std::errc()) {
+        literal_error("Float");
+    }
     return true;
 }
 
 bool Parser::identifier(AST *id) {
     if (!expect(IDENTIFIER)) return false;
-    id->str_value = curtok.value;
+    id->str_value = Name(curtok.value);
     return true;
 }
 
 
 bool Parser::isFactor() const {
-    return token_in({INTLIT, FLOATLIT, IDENTIFIER, LBRACE, LPAREN, ADD, SUB, SELF});
+    return token_in(first::FACTOR);
 }
 
 bool Parser::isAddop() const {
-    return token_in({ADD, SUB, OR});
+    return token_in(first::ADDOP);
 }
 
 bool Parser::isRelop() const {
-    return token_in({EQ, NEQ, LT, GT, LTEQ, GTEQ});
+    return token_in(first::RELOP);
 }
 
 bool Parser::isMultop() const {
-    return token_in({MUL, DIV, AND});
+    return token_in(first::MULTOP);
 }
 
 bool Parser::isStatement() const {
-    return token_in_values(statement_starters) || peek(IDENTIFIER);
+    return token_in(first::STATEMENT);
 }
 
 #pragma clang diagnostic pop
@@ -2,6 +2,9 @@
 
 #include "lexer.h"
 #include "ast.h"
+#include "context.h"
+#include "derivation.h"
+#include "tokenset.h"
 #include <initializer_list>
 #include <ostream>
 #include <utility>
@@ -9,38 +12,44 @@
 
 class Parser {
 public:
-    Parser(Lexer lexer, std::ostream &derivations, std::ostream &syntax_errors, std::ostream &ast_output)
-        : lexer(std::move(lexer)), derivations(derivations),
-          syntax_errors(syntax_errors), ast_output(ast_output) {};
+    /**
+     * @param context owns the nodes of the AST, which stay valid as long as the context
+     */
+    Parser(Lexer lexer, CompilationContext &context, std::ostream &derivations, std::ostream &syntax_errors,
+           DerivationMode derivation_mode = DerivationMode::FULL)
+        : lexer(std::move(lexer)), context(context), derivation(derivation_mode, derivations),
+          syntax_errors(syntax_errors) {};
     AST* parse();
 
     bool has_error = false;
 
 private:
     Lexer lexer;
+    CompilationContext &context;
     Token curtok;
     Token nexttok;
     std::vector<std::string> error_stack;
-    std::vector<std::string> derivation;
-    int derivation_index = 0;
-    std::ostream& derivations;
+    Derivation derivation;
     std::ostream& syntax_errors;
-    std::ostream& ast_output;
 
-    std::unordered_set<std::string> statement_starters = {"if", "while", "read", "write", "return", "self"};
+    // Allocates a node in the arena of the compilation
+    template<typename T, typename... Args>
+    T *make(Args &&... args) {
+        return context.arena.make<T>(std::forward<Args>(args)...);
+    }
 
-    bool token_in_values(const std::unordered_set<std::string>& values) const;
-    bool token_in(const std::unordered_set<TokenType>& types) const;
+    bool token_in(TokenSet types) const;
     void nextsym();
-    void error(const std::string &expected);
+    void error(std::string_view expected);
+    void literal_error(std::string_view kind);
     void print_derivation();
-    void insert_derivation(std::initializer_list<std::string> new_derivation);
-    void accept_token(std::string value);
+    void insert_derivation(std::initializer_list<std::string_view> new_derivation);
+    void accept_token(std::string_view value);
     void accept_epsilon();
     bool peek(TokenType type) const;
     bool match(TokenType type);
     bool expect(TokenType type);
-    bool skipErrors(const std::unordered_set<TokenType>& first, const std::unordered_set<TokenType>& follow);
+    bool skipErrors(TokenSet first, TokenSet follow);
 
     bool program(AST* p);
     bool block(AST* p);
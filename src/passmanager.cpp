@@ -0,0 +1,93 @@
+#include "passmanager.h"
+
+#include <iomanip>
+#include <string>
+
+using ir::Opcode;
+
+namespace {
+    int count_instructions(const ir::Module &module) {
+        int count = 0;
+        for (const auto &function: module.functions) {
+            for (const auto &block: function.blocks) {
+                for (const auto &instruction: block.instructions) {
+                    count += instruction.op != Opcode::COMMENT;
+                }
+            }
+        }
+        return count;
+    }
+}
+
+const CFG &AnalysisCache::cfg(const ir::Function &function) {
+    auto &entry = entries[&function];
+    if (entry.cfg) {
+        cfg_counter.reused++;
+    } else {
+        cfg_counter.computed++;
+        entry.cfg.emplace(function);
+    }
+    return *entry.cfg;
+}
+
+const dataflow::Liveness &AnalysisCache::liveness(const ir::Function &function) {
+    const auto &graph = cfg(function);
+    auto &entry = entries[&function];
+    if (entry.liveness) {
+        liveness_counter.reused++;
+    } else {
+        liveness_counter.computed++;
+        entry.liveness.emplace(dataflow::liveness(function, graph));
+    }
+    return *entry.liveness;
+}
+
+void AnalysisCache::invalidate(const ir::Function &function, Preserved preserved) {
+    auto entry = entries.find(&function);
+    if (entry == entries.end()) {
+        return;
+    }
+    if (entry->second.liveness) {
+        liveness_counter.invalidated++;
+        entry->second.liveness.reset();
+    }
+    if (preserved != Preserved::CFG && entry->second.cfg) {
+        cfg_counter.invalidated++;
+        entry->second.cfg.reset();
+    }
+}
+
+void AnalysisCache::print_stats(std::ostream &o) const {
+    o << std::left << std::setw(24) << "analysis" << std::setw(10) << "computed" << std::setw(10) << "reused"
+      << "invalidated" << '\n';
+    for (const auto &counter: {cfg_counter, liveness_counter}) {
+        o << std::left << std::setw(24) << counter.name << std::setw(10) << counter.computed << std::setw(10)
+          << counter.reused << counter.invalidated << '\n';
+    }
+}
+
+void PassManager::record(std::string_view name, int changes, std::chrono::nanoseconds time) {
+    passes.push_back({.name = name, .time = time, .changes = changes});
+}
+
+void PassManager::run(ir::Module &module) {
+    for (auto &entry: passes) {
+        if (!entry.pass) {
+            continue;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        entry.changes = entry.pass->run(module, analyses);
+        entry.time = std::chrono::steady_clock::now() - start;
+        entry.instructions = count_instructions(module);
+    }
+}
+
+void PassManager::print_stats(std::ostream &o) const {
+    o << std::left << std::setw(24) << "pass" << std::setw(10) << "changes" << std::setw(14) << "instructions"
+      << "time (us)" << '\n';
+    for (const auto &entry: passes) {
+        o << std::left << std::setw(24) << entry.name << std::setw(10) << entry.changes << std::setw(14)
+          << (entry.instructions ? std::to_string(*entry.instructions) : "-") << std::chrono::duration_cast<std::chrono::microseconds>(entry.time).count() << '\n';
+    }
+    analyses.print_stats(o);
+}
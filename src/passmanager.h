@@ -0,0 +1,104 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cfg.h"
+#include "dataflow.h"
+#include "ir.h"
+
+/**
+ * The CFG and the liveness of each function, computed when a pass first asks for them and handed to the passes after it
+ * until one of them changes the function. A pass that changes a function invalidates it, keeping the CFG when the
+ * blocks and the jumps between them are untouched.
+ */
+class AnalysisCache {
+public:
+    enum class Preserved {
+        NOTHING,
+        CFG, // Instructions were removed, moved or rewritten, but not blocks or the terminators ending them
+    };
+
+    const CFG &cfg(const ir::Function &function);
+    const dataflow::Liveness &liveness(const ir::Function &function);
+
+    void invalidate(const ir::Function &function, Preserved preserved = Preserved::NOTHING);
+
+    // Times each analysis was computed, handed out again and thrown away
+    void print_stats(std::ostream &o) const;
+
+private:
+    struct Entry {
+        std::optional<CFG> cfg;
+        std::optional<dataflow::Liveness> liveness;
+    };
+
+    struct Counter {
+        std::string_view name;
+        int computed = 0;
+        int reused = 0;
+        int invalidated = 0;
+    };
+
+    std::unordered_map<const ir::Function *, Entry> entries;
+    Counter cfg_counter = {.name = "cfg"};
+    Counter liveness_counter = {.name = "liveness"};
+};
+
+// A transformation of the three-address code of a module
+class Pass {
+public:
+    virtual ~Pass() = default;
+
+    [[nodiscard]] virtual std::string_view name() const = 0;
+    // Changes made, in the unit the report of the pass counts them in. Every function changed is invalidated in analyses
+    virtual int run(ir::Module &module, AnalysisCache &analyses) = 0;
+    virtual void print_report(std::ostream &o) const = 0;
+};
+
+/**
+ * Runs its passes over a module in the order they were added, sharing one AnalysisCache between them, and times each.
+ * Which passes are added follows from the optimization level, see OptimizationLevel.
+ */
+class PassManager {
+public:
+    template<typename T, typename... Args>
+    T &add(Args &&...args) {
+        auto pass = std::make_unique<T>(std::forward<Args>(args)...);
+        T &added = *pass;
+        passes.push_back({.name = added.name(), .pass = std::move(pass)});
+        return added;
+    }
+
+    // Counts a pass that ran over the AST before the three-address code existed, in the order of the passes added
+    void record(std::string_view name, int changes, std::chrono::nanoseconds time);
+
+    void run(ir::Module &module);
+
+    // Time, changes and instructions left after each pass, then the use of the analysis cache
+    void print_stats(std::ostream &o) const;
+
+private:
+    struct Entry {
+        std::string_view name;
+        std::unique_ptr<Pass> pass; // Null for a pass recorded over the AST
+        std::chrono::nanoseconds time{};
+        int changes = 0;
+        std::optional<int> instructions; // In the module after the pass, comments aside
+    };
+
+    std::vector<Entry> passes;
+    AnalysisCache analyses;
+};
+
+enum class OptimizationLevel {
+    O0, // No constant folding, no pass over the three-address code and no peephole rewrites
+    O1, // Constant folding, local value numbering and dead code elimination
+    O2, // Constant folding, inlining, dominator-based value numbering, loop optimization and dead code elimination
+};
@@ -0,0 +1,174 @@
+#include "peephole.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <optional>
+
+using moon::Line;
+
+namespace {
+    // Labels may be jumped to, so no pattern looks past one
+    std::optional<std::size_t> next_instruction(const std::vector<Line> &lines, std::size_t position) {
+        for (auto i = position + 1; i < lines.size(); i++) {
+            if (lines[i].is_label()) {
+                return std::nullopt;
+            }
+            if (lines[i].is_instruction()) {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+
+    bool is_control(const Line &line) {
+        return line.op == "j" || line.op == "jr" || line.op == "jl" || line.op == "jlr" || line.op == "bz" ||
+               line.op == "bnz" || line.op == "hlt";
+    }
+
+    void remove(Line &line) {
+        line = {};
+    }
+
+    // sw K(r14),rX then lw rY,K(r14): the value is still in rX
+    bool forward_store(std::vector<Line> &lines, std::size_t position) {
+        const auto &store = lines[position];
+        if (store.op != "sw" || !moon::frame_offset(store.operands[0])) {
+            return false;
+        }
+        auto next = next_instruction(lines, position);
+        if (!next) {
+            return false;
+        }
+        auto &load = lines[*next];
+        if (load.op != "lw" || moon::frame_offset(load.operands[1]) != moon::frame_offset(store.operands[0])) {
+            return false;
+        }
+        if (load.operands[0] == store.operands[1]) {
+            remove(load);
+        } else {
+            load = {.op = "addi", .operands = {load.operands[0], store.operands[1], "0"}, .comment = load.comment};
+        }
+        return true;
+    }
+
+    /**
+     * subi r14,r14,F ... addi r14,r14,F: the frame pointer comes back from one call only to move to the same place for
+     * the next one. It stays where it is, the frame accesses in between are shifted by F instead.
+     */
+    bool keep_frame(std::vector<Line> &lines, std::size_t position) {
+        const auto &restore = lines[position];
+        if (restore.op != "subi" || restore.operands[0] != "r14" || restore.operands[1] != "r14") {
+            return false;
+        }
+        const std::vector<std::string> move = {"r14", "r14", restore.operands[2]};
+        const int amount = std::stoi(restore.operands[2]);
+        std::vector<std::size_t> accesses;
+        for (auto i = position + 1; i < lines.size(); i++) {
+            auto &line = lines[i];
+            if (line.is_label()) {
+                return false;
+            }
+            if (!line.is_instruction()) {
+                continue;
+            }
+            if (line.op == "addi" && line.operands == move) {
+                for (auto access: accesses) {
+                    for (auto &operand: lines[access].operands) {
+                        if (auto offset = moon::frame_offset(operand)) {
+                            operand = moon::frame_operand(*offset - amount);
+                        }
+                    }
+                }
+                remove(lines[position]);
+                remove(line);
+                return true;
+            }
+            if (is_control(line)) {
+                return false;
+            }
+            for (const auto &operand: line.operands) {
+                if (operand == "r14") {
+                    return false;
+                }
+                if (auto offset = moon::frame_offset(operand)) {
+                    if (!moon::fits_immediate(*offset - amount)) {
+                        return false;
+                    }
+                    accesses.push_back(i);
+                }
+            }
+        }
+        return false;
+    }
+
+    // j L right before L, possibly among other labels
+    bool jump_to_next(std::vector<Line> &lines, std::size_t position) {
+        if (lines[position].op != "j") {
+            return false;
+        }
+        for (auto i = position + 1; i < lines.size(); i++) {
+            if (lines[i].is_instruction()) {
+                return false;
+            }
+            if (lines[i].label == lines[position].operands[0]) {
+                remove(lines[position]);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Nothing after an unconditional jump runs until the next label
+    bool unreachable(std::vector<Line> &lines, std::size_t position) {
+        const auto &op = lines[position].op;
+        if (op != "j" && op != "jr" && op != "hlt") {
+            return false;
+        }
+        auto end = position + 1;
+        bool dead_code = false;
+        for (; end < lines.size() && !lines[end].is_label(); end++) {
+            dead_code |= lines[end].is_instruction();
+        }
+        if (!dead_code) {
+            return false;
+        }
+        for (auto i = position + 1; i < end; i++) {
+            remove(lines[i]);
+        }
+        return true;
+    }
+}
+
+Peephole::Peephole() {
+    add_pattern("forward-store", forward_store);
+    add_pattern("keep-frame", keep_frame);
+    add_pattern("jump-to-next", jump_to_next);
+    add_pattern("unreachable", unreachable);
+}
+
+void Peephole::add_pattern(std::string_view name, Rewrite rewrite) {
+    table.push_back({name, rewrite});
+}
+
+void Peephole::run(std::vector<moon::Line> &lines) {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (std::size_t position = 0; position < lines.size(); position++) {
+            for (auto &pattern: table) {
+                if (lines[position].is_instruction() && pattern.rewrite(lines, position)) {
+                    pattern.hits++;
+                    changed = true;
+                }
+            }
+        }
+        std::erase_if(lines, [](const moon::Line &line) { return line.empty(); });
+    }
+}
+
+void Peephole::print_stats(std::ostream &o) const {
+    o << std::left << std::setw(16) << "pattern" << "hits" << '\n';
+    for (const auto &pattern: table) {
+        o << std::left << std::setw(16) << pattern.name << pattern.hits << '\n';
+    }
+}
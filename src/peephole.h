@@ -0,0 +1,42 @@
+#pragma once
+
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+#include "moon.h"
+
+/**
+ * Rewrites short sequences of MOON instructions into cheaper ones. Every pattern of the table is tried at every
+ * instruction of a function until none of them applies any more, and counts how often it did.
+ */
+class Peephole {
+public:
+    /**
+     * Tries to rewrite the code starting at an instruction. Removed lines are cleared and only dropped once a pass over
+     * the function is over, so positions stay valid while the patterns run.
+     * @return whether the code changed
+     */
+    using Rewrite = bool (*)(std::vector<moon::Line> &lines, std::size_t position);
+
+    struct Pattern {
+        std::string_view name;
+        Rewrite rewrite;
+        int hits = 0;
+    };
+
+    // Starts with the default patterns
+    Peephole();
+
+    // Patterns are tried in the order they are added
+    void add_pattern(std::string_view name, Rewrite rewrite);
+
+    void run(std::vector<moon::Line> &lines);
+
+    [[nodiscard]] const std::vector<Pattern> &patterns() const { return table; }
+
+    void print_stats(std::ostream &o) const;
+
+private:
+    std::vector<Pattern> table;
+};
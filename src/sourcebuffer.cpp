@@ -0,0 +1,62 @@
+#include "sourcebuffer.h"
+
+#include <fstream>
+#include <sstream>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SOURCEBUFFER_MMAP 1
+#endif
+
+SourceBuffer::~SourceBuffer() {
+    close();
+}
+
+bool SourceBuffer::open(const std::string &filename) {
+    close();
+
+#ifdef SOURCEBUFFER_MMAP
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info{};
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void *address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            mapped = static_cast<const char *>(address);
+            mapped_size = info.st_size;
+            ::close(fd);
+            opened = true;
+            return true;
+        }
+    }
+    ::close(fd);
+#endif
+
+    // Empty files, pipes, or platforms without mmap: read the whole file at once
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    contents = std::move(ss).str();
+    opened = true;
+    return true;
+}
+
+void SourceBuffer::close() {
+#ifdef SOURCEBUFFER_MMAP
+    if (mapped != nullptr) {
+        munmap(const_cast<char *>(mapped), mapped_size);
+    }
+#endif
+    mapped = nullptr;
+    mapped_size = 0;
+    contents.clear();
+    opened = false;
+}
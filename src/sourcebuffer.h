@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * Read-only view of a whole source file. The file is memory mapped when the platform supports it, otherwise it is
+ * read into memory once. The view stays valid for the lifetime of the buffer.
+ */
+class SourceBuffer {
+public:
+    SourceBuffer() = default;
+    SourceBuffer(const SourceBuffer &) = delete;
+    SourceBuffer &operator=(const SourceBuffer &) = delete;
+    ~SourceBuffer();
+
+    /**
+     * Opens and maps the file
+     * @param filename path of the file to read
+     * @return false if the file could not be read
+     */
+    bool open(const std::string &filename);
+
+    void close();
+
+    [[nodiscard]] bool is_open() const { return opened; }
+
+    [[nodiscard]] std::string_view view() const {
+        return mapped != nullptr ? std::string_view(mapped, mapped_size) : std::string_view(contents);
+    }
+
+private:
+    const char *mapped = nullptr;
+    std::size_t mapped_size = 0;
+    std::string contents; // Fallback storage when the file cannot be mapped
+    bool opened = false;
+};
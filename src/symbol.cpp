@@ -2,9 +2,26 @@
 
 using std::setw;
 
+std::string_view to_string(SymbolKind kind) {
+    switch (kind) {
+        case SymbolKind::CLASS: return "class";
+        case SymbolKind::FUNCTION: return "function";
+        case SymbolKind::METHOD: return "method";
+        case SymbolKind::DATA: return "data";
+        case SymbolKind::PARAM: return "param";
+        case SymbolKind::LOCAL: return "local";
+        case SymbolKind::TEMP: return "temp";
+        case SymbolKind::LIT: return "lit";
+        case SymbolKind::RETURN: return "return";
+        case SymbolKind::JUMP: return "jump";
+        case SymbolKind::ERROR: return "error";
+    }
+    return "";
+}
+
 [[nodiscard]] std::string Symbol::to_string() const {
     std::stringstream ss;
-    ss << "│ " << std::left << setw(8) << kind << " │ " << setw(20) << name << " │ " << setw(13) << type
+    ss << "│ " << std::left << setw(8) << ::to_string(kind) << " │ " << setw(20) << name << " │ " << setw(13) << type
             << " │ " << setw(8) << size << " │ " << setw(8) << offset << " │";
     if (subtable) {
         ss << subtable->to_string();
@@ -15,7 +32,7 @@ using std::setw;
 
 [[nodiscard]] std::string VarSymbol::to_string() const {
     std::stringstream ss;
-    ss << "│ " << std::left << setw(8) << kind << " │ " << setw(19) << name << " │ " << setw(10) << type <<
+    ss << "│ " << std::left << setw(8) << ::to_string(kind) << " │ " << setw(19) << name << " │ " << setw(10) << type <<
             " │ " << setw(5) << size << " │ " << setw(5) << offset << " │ " << setw(7) << (is_public ? "public" : "private") <<
             " │";
     if (subtable) {
@@ -27,7 +44,7 @@ using std::setw;
 
 [[nodiscard]] std::string FuncSymbol::to_string() const {
     std::stringstream ss;
-    ss << "│ " << std::left << setw(8) << kind << " │ " << setw(11) << name << " │ " << setw(9) << type
+    ss << "│ " << std::left << setw(8) << ::to_string(kind) << " │ " << setw(11) << name << " │ " << setw(9) << type
             << " │ ";
     std::string args_str;
     args_str = '(';
@@ -35,7 +52,7 @@ using std::setw;
         if (i != 0) {
             args_str += ", ";
         }
-        args_str += args[i];
+        args_str += args[i].str();
     }
     args_str += ')';
     ss << setw(22) << args_str;
@@ -1,18 +1,31 @@
 #pragma once
 
 #include <string>
-#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
 #include <symtable.h>
 
-using std::shared_ptr;
+#include "name.h"
 
 struct SymbolTable;
 
+enum class SymbolKind {
+    CLASS, FUNCTION, METHOD, DATA, PARAM, LOCAL, TEMP, LIT, RETURN, JUMP, ERROR,
+};
+
+// Name of the kind in the symbol table output
+std::string_view to_string(SymbolKind kind);
+
+/**
+ * Symbols live in the arena of the CompilationContext, everything else only holds plain pointers to them. The kind
+ * also tells which struct a symbol is, see symbol_cast.
+ */
 struct Symbol {
-    std::string kind;
-    std::string type;
-    std::string name;
-    shared_ptr<SymbolTable> subtable;
+    SymbolKind kind;
+    Name type;
+    Name name;
+    SymbolTable *subtable;
     std::vector<int> dimensions;
 
     Symbol *reference = nullptr; // this is used for things like function calls
@@ -21,19 +34,19 @@ struct Symbol {
     int size = 0;
     int offset = 0;
 
-    Symbol(std::string kind, std::string type, std::string name, shared_ptr<SymbolTable> subtable = nullptr) : kind(std::move(kind)),
-        type(std::move(type)), name(std::move(name)), subtable(std::move(subtable)) {
+    Symbol(SymbolKind kind, Name type, Name name, SymbolTable *subtable = nullptr) : kind(kind),
+        type(type), name(name), subtable(subtable) {
     };
 
     void calculate_size() {
         // Doing this to avoid considering a class like "integer" as an int type
-        if (type == "int" || type.rfind("int[]", 0) == 0) {
+        if (type == names::int_type || type.str().starts_with("int[]")) {
             base_size = 4;
         }
-        else if (type == "float" || type.rfind("float[]", 0) == 0) {
+        else if (type == names::float_type || type.str().starts_with("float[]")) {
             base_size = 8;
         }
-        else if (type == "bool") {
+        else if (type == names::bool_type) {
             base_size = 4;
         }
 
@@ -60,8 +73,10 @@ struct Symbol {
 struct VarSymbol : public Symbol {
     bool is_public = false;
 
-    VarSymbol(std::string kind, std::string type, std::string name, bool is_public, shared_ptr<SymbolTable> subtable = nullptr) :
-        Symbol(std::move(kind), std::move(type), std::move(name), std::move(subtable)), is_public(is_public) { }
+    VarSymbol(SymbolKind kind, Name type, Name name, bool is_public, SymbolTable *subtable = nullptr) :
+        Symbol(kind, type, name, subtable), is_public(is_public) { }
+
+    static bool holds(SymbolKind kind) { return kind == SymbolKind::DATA; }
 
     [[nodiscard]] std::string to_string() const override;
 };
@@ -71,10 +86,18 @@ struct FuncSymbol : public Symbol {
     bool is_public = true;
     bool declared = false;
     bool defined = false;
-    std::vector<std::string> args;
+    std::vector<Name> args;
 
-    FuncSymbol(std::string kind, std::string type, std::string name, std::vector<std::string> args, bool is_public = true, shared_ptr<SymbolTable> subtable = nullptr) :
-        Symbol(std::move(kind), std::move(type), std::move(name), std::move(subtable)), is_public(is_public), args(std::move(args)) { }
+    FuncSymbol(SymbolKind kind, Name type, Name name, std::vector<Name> args, bool is_public = true, SymbolTable *subtable = nullptr) :
+        Symbol(kind, type, name, subtable), is_public(is_public), args(std::move(args)) { }
+
+    static bool holds(SymbolKind kind) { return kind == SymbolKind::FUNCTION || kind == SymbolKind::METHOD; }
 
     [[nodiscard]] std::string to_string() const override;
-};
\ No newline at end of file
+};
+
+// Downcast checked against the kind instead of RTTI, nullptr when the symbol is not a T
+template<typename T>
+T *symbol_cast(Symbol *symbol) {
+    return symbol != nullptr && T::holds(symbol->kind) ? static_cast<T *>(symbol) : nullptr;
+}
\ No newline at end of file
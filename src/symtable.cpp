@@ -3,12 +3,34 @@
 #include <cassert>
 #include <sstream>
 
-void SymbolTable::add_entry(const shared_ptr<Symbol> &symbol) {
+void SymbolTable::add_entry(Symbol *symbol) {
     assert(symbol);
     symbols.push_back(symbol);
+    index_entry(symbols.size() - 1);
 }
 
-shared_ptr<Symbol> SymbolTable::lookup(const std::string &name) {
+void SymbolTable::remove_entries(const std::unordered_set<Symbol*> &removed) {
+    if (removed.empty()) {
+        return;
+    }
+    std::erase_if(symbols, [&](Symbol *symbol) { return removed.contains(symbol); });
+    // Positions shift, the indices are rebuilt once for the whole batch
+    by_name.clear();
+    by_signature.clear();
+    for (std::size_t position = 0; position < symbols.size(); position++) {
+        index_entry(position);
+    }
+}
+
+void SymbolTable::index_entry(std::size_t position) {
+    auto symbol = symbols[position];
+    by_name[symbol->name].push_back(position);
+    if (auto func_symbol = symbol_cast<FuncSymbol>(symbol)) {
+        by_signature.try_emplace({func_symbol->name, func_symbol->args}, func_symbol);
+    }
+}
+
+Symbol *SymbolTable::lookup(Name name) {
     if (auto symbol = find_child(name)) {
         return symbol;
     }
@@ -18,40 +40,43 @@ shared_ptr<Symbol> SymbolTable::lookup(const std::string &name) {
     return nullptr;
 }
 
-shared_ptr<Symbol> SymbolTable::find_child(const std::string &name, const std::string &kind) const {
-    for (auto &symbol: symbols) {
-        if (symbol->name == name) {
-            if (kind.empty() || symbol->kind == kind) {
-                return symbol;
-            }
+Symbol *SymbolTable::find_child(Name name, std::optional<SymbolKind> kind) const {
+    auto it = by_name.find(name);
+    if (it == by_name.end()) {
+        return nullptr;
+    }
+    for (auto position: it->second) {
+        if (!kind || symbols[position]->kind == *kind) {
+            return symbols[position];
         }
     }
     return nullptr;
 }
 
-shared_ptr<FuncSymbol> SymbolTable::find_func_child(const std::string &name, const std::vector<std::string> &args) {
-    for (const auto& symbol: symbols) {
-        if (symbol->name == name) {
-            auto func_symbol = std::dynamic_pointer_cast<FuncSymbol>(symbol);
-            if (func_symbol && func_symbol->args == args) {
-                return func_symbol;
-            }
-        }
+FuncSymbol *SymbolTable::find_func_child(Name name, const std::vector<Name> &args) {
+    auto it = by_signature.find({name, args});
+    return it != by_signature.end() ? it->second : nullptr;
+}
+
+std::size_t SymbolTable::SignatureHash::operator()(const Signature &signature) const {
+    std::size_t hash = signature.name.hash();
+    for (const auto &arg: signature.args) {
+        hash = hash * 31 + arg.hash();
     }
-    return nullptr;
+    return hash;
 }
 
 std::string SymbolTable::get_unique_name() const {
-    if (name == "global") return "g";
-    std::string unique_name = name;
+    if (name == names::global) return "g";
+    std::string unique_name = name.str();
 
     if (parent != nullptr) {
         unique_name = parent->get_unique_name() + "_" + unique_name;
     }
 
     for (auto &symbol: symbols) {
-        if (symbol->kind == "param") {
-            unique_name += "_" + symbol->name;
+        if (symbol->kind == SymbolKind::PARAM) {
+            unique_name += "_" + symbol->name.str();
         }
     }
 
@@ -67,7 +92,11 @@ std::string SymbolTable::get_unique_name() const {
     }
     ss << std::endl << std::left;
     ss << prefix << "┌───────────────────────────────────────────────────────────────────────┐" << std::endl;
-    ss << prefix << std::setw(60) << ("│ table: " + name) << std::setw(15) << ("│ size: " + std::to_string(size)) << " │" << std::endl;
+    ss << prefix << std::setw(60) << ("│ table: " + name.str()) << std::setw(15) << ("│ size: " + std::to_string(size)) << " │" << std::endl;
+    if (unshared_size != size) {
+        ss << prefix << std::setw(74) << ("│ size without temporary slot sharing: " + std::to_string(unshared_size)) << "│"
+           << std::endl;
+    }
     ss << prefix << "├───────────────────────────────────────────────────────────────────────┤" << std::endl;
     for (auto &symbol: symbols) {
         ss << prefix << symbol->to_string() << std::endl;
@@ -78,31 +107,9 @@ std::string SymbolTable::get_unique_name() const {
 }
 
 
-shared_ptr<Symbol> ClassSymbolTable::lookup(const std::string &name) {
-    for (auto symbol: symbols) {
-        if (symbol->name == name) {
-            return symbol;
-        }
-    }
-    for (const auto& parent: parents) {
-        auto symbol = parent->find_child(name);
-        if (symbol != nullptr) {
-            return symbol;
-        }
-    }
-    if (parent != nullptr) {
-        return parent->lookup(name);
-    }
-    return nullptr;
-}
-
-shared_ptr<Symbol> ClassSymbolTable::find_child(const std::string &name, const std::string &kind) const {
-    for (auto &symbol: symbols) {
-        if (symbol->name == name) {
-            if (kind.empty() || symbol->kind == kind) {
-                return symbol;
-            }
-        }
+Symbol *ClassSymbolTable::find_child(Name name, std::optional<SymbolKind> kind) const {
+    if (auto symbol = SymbolTable::find_child(name, kind)) {
+        return symbol;
     }
     for (const auto& parent: parents) {
         auto symbol = parent->find_child(name, kind);
@@ -112,4 +119,3 @@ shared_ptr<Symbol> ClassSymbolTable::find_child(const std::string &name, const s
     }
     return nullptr;
 }
-
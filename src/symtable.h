@@ -1,51 +1,88 @@
 #pragma once
 
 #include <iomanip>
-#include <memory>
+#include <optional>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "name.h"
 #include "symbol.h"
 
-using std::shared_ptr;
-
 struct Symbol;
 struct FuncSymbol;
+enum class SymbolKind;
 
+// Like symbols, tables are owned by the arena of the CompilationContext
 struct SymbolTable {
-    std::string name;
+    Name name;
     int level = 0;
     SymbolTable* parent = nullptr;
-    std::vector<shared_ptr<Symbol>> symbols;
+    // In insertion order, entries must only be changed through add_entry and remove_entries so the indices stay in sync
+    std::vector<Symbol*> symbols;
     int size = 0;
+    // Size of the frame if every temporary had a slot of its own
+    int unshared_size = 0;
+    const bool is_class = false;
 
-    SymbolTable(int level, std::string name, SymbolTable* parent = nullptr) : name(std::move(name)), level(level),
-                                                                              parent(parent) { }
+    SymbolTable(int level, Name name, SymbolTable* parent = nullptr) : SymbolTable(level, name, parent, false) { }
     virtual ~SymbolTable() = default;
 
-    void add_entry(const shared_ptr<Symbol>& symbol);
+    void add_entry(Symbol* symbol);
+
+    // Removes every entry in the set, keeping the order of the others
+    void remove_entries(const std::unordered_set<Symbol*> &removed);
 
-    virtual shared_ptr<Symbol> lookup(const std::string &name);
+    virtual Symbol* lookup(Name name);
 
-    [[nodiscard]] virtual shared_ptr<Symbol> find_child(const std::string &name, const std::string &kind = "") const;
+    [[nodiscard]] virtual Symbol* find_child(Name name, std::optional<SymbolKind> kind = {}) const;
 
-    virtual shared_ptr<FuncSymbol> find_func_child(const std::string &name, const std::vector<std::string> &args);
+    virtual FuncSymbol* find_func_child(Name name, const std::vector<Name> &args);
 
     std::string get_unique_name() const;
 
     [[nodiscard]] virtual std::string to_string() const;
+
+protected:
+    SymbolTable(int level, Name name, SymbolTable* parent, bool is_class) : name(name), level(level), parent(parent),
+        is_class(is_class) { }
+
+private:
+    void index_entry(std::size_t position);
+
+    // Overloads are told apart by their parameter types
+    struct Signature {
+        Name name;
+        std::vector<Name> args;
+
+        bool operator==(const Signature &other) const = default;
+    };
+
+    struct SignatureHash {
+        std::size_t operator()(const Signature &signature) const;
+    };
+
+    // Positions in symbols of every entry with a given name, in insertion order
+    std::unordered_map<Name, std::vector<std::size_t>> by_name;
+    // First function added with a given signature
+    std::unordered_map<Signature, FuncSymbol*, SignatureHash> by_signature;
 };
 
 // Allow for inheritance
 struct ClassSymbolTable : public SymbolTable {
     bool declared = false;
     bool implemented = false;
-    std::vector<std::shared_ptr<ClassSymbolTable>> parents;
+    std::vector<ClassSymbolTable*> parents;
 
-    ClassSymbolTable(int level, std::string name, SymbolTable* parent) : SymbolTable(level, std::move(name), parent) { }
+    ClassSymbolTable(int level, Name name, SymbolTable* parent) : SymbolTable(level, name, parent, true) { }
 
-    shared_ptr<Symbol> lookup(const std::string &name) override;
+    // Also searches the inherited classes
+    [[nodiscard]] Symbol* find_child(Name name, std::optional<SymbolKind> kind = {}) const override;
+};
 
-    [[nodiscard]] shared_ptr<Symbol> find_child(const std::string &name, const std::string &kind = "") const override;
-};
\ No newline at end of file
+// Downcast checked against is_class instead of RTTI, nullptr when the table is not a class
+inline ClassSymbolTable* as_class_table(SymbolTable* table) {
+    return table != nullptr && table->is_class ? static_cast<ClassSymbolTable*>(table) : nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <initializer_list>
+#include "lexer.h"
+
+/**
+ * Set of token types stored as one bit per type, so sets can be built at compile time and membership is a single AND.
+ * Iteration goes through the types in enum order.
+ */
+class TokenSet {
+public:
+    class iterator {
+    public:
+        constexpr explicit iterator(std::uint64_t bits) : bits(bits) {}
+
+        constexpr TokenType operator*() const { return static_cast<TokenType>(std::countr_zero(bits)); }
+
+        constexpr iterator &operator++() {
+            bits &= bits - 1;
+            return *this;
+        }
+
+        constexpr bool operator==(const iterator &other) const = default;
+
+    private:
+        std::uint64_t bits;
+    };
+
+    constexpr TokenSet() = default;
+
+    constexpr TokenSet(std::initializer_list<TokenType> types) {
+        for (TokenType type: types) {
+            bits |= bit(type);
+        }
+    }
+
+    [[nodiscard]] constexpr bool contains(TokenType type) const { return (bits & bit(type)) != 0; }
+
+    [[nodiscard]] constexpr int size() const { return std::popcount(bits); }
+
+    [[nodiscard]] constexpr bool empty() const { return bits == 0; }
+
+    constexpr TokenSet operator|(TokenSet other) const { return TokenSet(bits | other.bits); }
+
+    constexpr bool operator==(const TokenSet &other) const = default;
+
+    [[nodiscard]] constexpr iterator begin() const { return iterator(bits); }
+
+    [[nodiscard]] constexpr iterator end() const { return iterator(0); }
+
+private:
+    std::uint64_t bits = 0;
+
+    constexpr explicit TokenSet(std::uint64_t bits) : bits(bits) {}
+
+    static constexpr std::uint64_t bit(TokenType type) { return std::uint64_t{1} << static_cast<int>(type); }
+};
+
+static_assert(static_cast<int>(TokenType::EPSILON) < 64, "TokenSet needs one bit per token type");
@@ -0,0 +1,283 @@
+#include "valuenumbering.h"
+
+#include <functional>
+#include <numeric>
+
+#include "moonemitter.h"
+
+using ir::Opcode;
+
+std::size_t ValueNumbering::KeyHash::operator()(const Key &key) const {
+    std::size_t hash = static_cast<std::size_t>(key.op);
+    for (auto part: {key.lhs, key.rhs, key.imm}) {
+        hash = hash * 31 + std::hash<int>{}(part);
+    }
+    return hash;
+}
+
+int ValueNumbering::run(ir::Module &module, AnalysisCache &analyses) {
+    int eliminated = 0;
+    for (auto &function: module.functions) {
+        // Only instructions that are not terminators are removed, the CFG holds for every attempt
+        const auto &graph = analyses.cfg(function);
+        const auto original = function;
+        Report report = {.function = function.name};
+        bool fits = number_function(function, graph, scope, report);
+        if (!fits && scope == Scope::DOMINATORS) {
+            function = original;
+            report = {.function = function.name, .fallback = Scope::LOCAL};
+            fits = number_function(function, graph, Scope::LOCAL, report);
+        }
+        if (!fits) {
+            function = original;
+            report = {.function = function.name, .unchanged = true};
+        }
+        if (report.local + report.dominators > 0) {
+            analyses.invalidate(function, AnalysisCache::Preserved::CFG);
+            eliminated += report.local + report.dominators;
+        }
+        reports.push_back(report);
+    }
+    return eliminated;
+}
+
+bool ValueNumbering::number_function(ir::Function &function, const CFG &graph, Scope scope, Report &report) {
+    this->function = &function;
+    cfg = &graph;
+    number.resize(function.registers);
+    std::iota(number.begin(), number.end(), 0);
+    table.clear();
+    undo.clear();
+    region_effects.clear();
+    block_effects.assign(graph.size(), {});
+    removed.clear();
+    rewritten.assign(function.registers, false);
+    std::vector<bool> written(function.registers, false);
+    for (int block = 0; block < graph.size(); block++) {
+        const auto &instructions = function.blocks[block].instructions;
+        removed.emplace_back(instructions.size(), false);
+        for (const auto &instruction: instructions) {
+            if (instruction.dst != ir::no_reg) {
+                if (written[instruction.dst]) {
+                    rewritten[instruction.dst] = true;
+                }
+                written[instruction.dst] = true;
+            }
+            block_effects[block].call |= is_call(instruction);
+            if (instruction.op == Opcode::STORE || instruction.op == Opcode::READ) {
+                block_effects[block].written.insert(instruction.imm);
+            }
+        }
+    }
+
+    if (scope == Scope::LOCAL) {
+        for (auto block: graph.reverse_postorder()) {
+            table.clear();
+            number_block(block, scope, report);
+        }
+    } else if (graph.size() > 0) {
+        number_block(0, scope, report);
+    }
+
+    // Unreachable blocks are not numbered, but may still read the registers of removed instructions
+    for (int block = 0; block < graph.size(); block++) {
+        auto &instructions = function.blocks[block].instructions;
+        std::vector<ir::Instruction> kept;
+        for (std::size_t index = 0; index < instructions.size(); index++) {
+            if (removed[block][index]) {
+                continue;
+            }
+            auto &i = instructions[index];
+            for (auto reg: {&i.lhs, &i.rhs}) {
+                if (*reg != ir::no_reg) {
+                    *reg = number[*reg];
+                }
+            }
+            for (auto &arg: i.args) {
+                arg = number[arg];
+            }
+            kept.push_back(std::move(i));
+        }
+        instructions = std::move(kept);
+    }
+    this->function = nullptr;
+    cfg = nullptr;
+    return MoonEmitter::fits_registers(function);
+}
+
+void ValueNumbering::number_block(int block, Scope scope, Report &report) {
+    const auto mark = undo.size();
+    auto &instructions = function->blocks[block].instructions;
+    for (int index = 0; index < static_cast<int>(instructions.size()); index++) {
+        auto &i = instructions[index];
+        for (auto reg: {&i.lhs, &i.rhs}) {
+            if (*reg != ir::no_reg) {
+                *reg = number[*reg];
+            }
+        }
+        for (auto &arg: i.args) {
+            arg = number[arg];
+        }
+        const Position here = {block, index};
+        const bool numbered = (i.dst == ir::no_reg || !rewritten[i.dst]) && (i.lhs == ir::no_reg || !rewritten[i.lhs]) &&
+                              (i.rhs == ir::no_reg || !rewritten[i.rhs]);
+        if (!numbered) {
+            continue;
+        }
+        if (auto computed = key(i)) {
+            auto it = table.find(*computed);
+            if (it != table.end() && !clobbered(*computed, it->second.position, here)) {
+                number[i.dst] = it->second.value;
+                removed[block][index] = true;
+                (it->second.position.block == block ? report.local : report.dominators)++;
+                continue;
+            }
+            define(*computed, {i.dst, here});
+        } else if (i.op == Opcode::STORE) {
+            // Loading the slot back gives the stored register
+            define({.op = Opcode::LOAD, .lhs = ir::no_reg, .rhs = ir::no_reg, .imm = i.imm}, {i.lhs, here});
+        }
+    }
+
+    if (scope == Scope::DOMINATORS) {
+        for (auto dominated: cfg->dominated(block)) {
+            number_block(dominated, scope, report);
+        }
+        while (undo.size() > mark) {
+            auto &[key, entry] = undo.back();
+            if (entry) {
+                table.insert_or_assign(key, *entry);
+            } else {
+                table.erase(key);
+            }
+            undo.pop_back();
+        }
+    }
+}
+
+void ValueNumbering::define(const Key &key, Entry entry) {
+    auto it = table.find(key);
+    undo.emplace_back(key, it == table.end() ? std::nullopt : std::optional<Entry>(it->second));
+    table.insert_or_assign(key, entry);
+}
+
+std::optional<ValueNumbering::Key> ValueNumbering::key(const ir::Instruction &instruction) {
+    const auto &i = instruction;
+    switch (i.op) {
+        case Opcode::CONST:
+        case Opcode::LOAD:
+            return Key{i.op, ir::no_reg, ir::no_reg, i.imm};
+        case Opcode::ADD:
+        case Opcode::MUL:
+        case Opcode::CEQ:
+        case Opcode::CNE:
+            // Commutative, the operands are put in order so both orders agree
+            if (i.rhs != ir::no_reg) {
+                return Key{i.op, std::min(i.lhs, i.rhs), std::max(i.lhs, i.rhs), 0};
+            }
+            return Key{i.op, i.lhs, ir::no_reg, i.imm};
+        default:
+            if (ir::is_binary(i.op)) {
+                return Key{i.op, i.lhs, i.rhs, i.rhs == ir::no_reg ? i.imm : 0};
+            }
+            return std::nullopt;
+    }
+}
+
+bool ValueNumbering::is_call(const ir::Instruction &instruction) {
+    return instruction.op == Opcode::CALL || instruction.op == Opcode::WRITE || instruction.op == Opcode::READ;
+}
+
+bool ValueNumbering::clobbers(const Key &key, const ir::Instruction &instruction) {
+    if (is_call(instruction)) {
+        return true;
+    }
+    return key.op == Opcode::LOAD && (instruction.op == Opcode::STORE || instruction.op == Opcode::READ) &&
+           instruction.imm == key.imm;
+}
+
+bool ValueNumbering::clobbered(const Key &key, Position from, Position to) {
+    const auto &from_instructions = function->blocks[from.block].instructions;
+    if (from.block == to.block) {
+        for (int index = from.index + 1; index < to.index; index++) {
+            if (clobbers(key, from_instructions[index])) {
+                return true;
+            }
+        }
+        return false;
+    }
+    // The rest of the block of the value, the blocks on the paths from there, then the start of the block reusing it
+    for (int index = from.index + 1; index < static_cast<int>(from_instructions.size()); index++) {
+        if (clobbers(key, from_instructions[index])) {
+            return true;
+        }
+    }
+    const auto &to_instructions = function->blocks[to.block].instructions;
+    for (int index = 0; index < to.index; index++) {
+        if (clobbers(key, to_instructions[index])) {
+            return true;
+        }
+    }
+    const auto &between = effects(from.block, to.block);
+    return between.call || (key.op == Opcode::LOAD && between.written.contains(key.imm));
+}
+
+const ValueNumbering::Effects &ValueNumbering::effects(int from, int to) {
+    const long long pair = static_cast<long long>(from) * cfg->size() + to;
+    if (auto it = region_effects.find(pair); it != region_effects.end()) {
+        return it->second;
+    }
+    // Blocks reachable from the successors, or the predecessors, of a block without going through the stops
+    auto reached = [&](int start, bool forward, int stop, int other_stop) {
+        std::vector<bool> visited(cfg->size(), false);
+        auto next = [&](int block) -> const std::vector<int> & {
+            return forward ? cfg->successors(block) : cfg->predecessors(block);
+        };
+        std::vector<int> stack(next(start).begin(), next(start).end());
+        while (!stack.empty()) {
+            const int block = stack.back();
+            stack.pop_back();
+            if (visited[block] || block == stop || block == other_stop) {
+                continue;
+            }
+            visited[block] = true;
+            stack.insert(stack.end(), next(block).begin(), next(block).end());
+        }
+        return visited;
+    };
+    // A path back through the block of the value computes it again. The blocks between it and the reuse count, and
+    // when the reuse is in a loop that does not go through the value, so do the blocks of that loop.
+    const auto after_value = reached(from, true, from, -1);
+    const auto before_reuse = reached(to, false, from, -1);
+    std::vector<bool> between(cfg->size(), false);
+    for (int block = 0; block < cfg->size(); block++) {
+        between[block] = block != to && after_value[block] && before_reuse[block];
+    }
+    if (before_reuse[to]) {
+        between[to] = true;
+    }
+    Effects result;
+    for (int block = 0; block < cfg->size(); block++) {
+        if (between[block]) {
+            result.call |= block_effects[block].call;
+            result.written.insert(block_effects[block].written.begin(), block_effects[block].written.end());
+        }
+    }
+    return region_effects.emplace(pair, std::move(result)).first->second;
+}
+
+void ValueNumbering::print_report(std::ostream &o) const {
+    for (const auto &report: reports) {
+        o << report.function << ": ";
+        if (report.unchanged) {
+            o << "unchanged, the values reused would not fit in registers\n";
+            continue;
+        }
+        o << report.local + report.dominators << " instructions eliminated, " << report.local << " in their block, "
+          << report.dominators << " from a dominating block";
+        if (report.fallback) {
+            o << " (local only, reusing values across blocks would not fit in registers)";
+        }
+        o << '\n';
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <optional>
+#include <ostream>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "cfg.h"
+#include "ir.h"
+#include "passmanager.h"
+
+/**
+ * Removes the instructions computing a value some earlier instruction already computed, and has their uses read the
+ * earlier register instead. Virtual registers are only written once, so two operations agree when they apply the same
+ * operator to the same values. The registers loop optimization updates on every iteration are the exception, and are
+ * left out. A load agrees with an earlier load of the same slot, or with the store of a register to
+ * it, as long as no instruction on a path between them writes the slot.
+ *
+ * Local numbering only looks back in the block of an instruction. Dominator-based numbering also looks in the blocks
+ * that dominate it, walking the dominator tree with a table scoped to the blocks above. A value is not reused across a
+ * call or a library routine, which clobber every register, and a function whose values would then need more than the
+ * registers of MoonEmitter falls back to local numbering, then to its original code.
+ */
+class ValueNumbering : public Pass {
+public:
+    enum class Scope {
+        LOCAL,
+        DOMINATORS,
+    };
+
+    explicit ValueNumbering(Scope scope) : scope(scope) {}
+
+    [[nodiscard]] std::string_view name() const override { return "value-numbering"; }
+    // Instructions eliminated
+    int run(ir::Module &module, AnalysisCache &analyses) override;
+
+    // Instructions removed from each function
+    void print_report(std::ostream &o) const override;
+
+private:
+    struct Key {
+        ir::Opcode op;
+        ir::VReg lhs;
+        ir::VReg rhs;
+        int imm;
+
+        bool operator==(const Key &other) const = default;
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key &key) const;
+    };
+
+    struct Position {
+        int block;
+        int index;
+    };
+
+    // Where a value is available from
+    struct Entry {
+        ir::VReg value;
+        Position position;
+    };
+
+    // What the blocks between two others may do to the values computed before them
+    struct Effects {
+        bool call = false;
+        std::unordered_set<int> written; // Slots
+    };
+
+    struct Report {
+        Name function;
+        int local = 0;
+        int dominators = 0;
+        std::optional<Scope> fallback; // Scope the function was numbered with instead, when values did not fit
+        bool unchanged = false; // Even local numbering did not fit
+    };
+
+    Scope scope;
+    std::vector<Report> reports;
+
+    // State of the function being numbered
+    ir::Function *function = nullptr;
+    const CFG *cfg = nullptr;
+    std::vector<ir::VReg> number; // Register each register is replaced by
+    std::unordered_map<Key, Entry, KeyHash> table;
+    std::vector<std::pair<Key, std::optional<Entry>>> undo; // Entries replaced in the table, to leave a block
+    std::vector<Effects> block_effects;
+    std::unordered_map<long long, Effects> region_effects; // By pair of blocks
+    std::vector<std::vector<bool>> removed; // By block and instruction
+    std::vector<bool> rewritten; // Registers written more than once
+
+    bool number_function(ir::Function &function, const CFG &graph, Scope scope, Report &report);
+    void number_block(int block, Scope scope, Report &report);
+    void define(const Key &key, Entry entry);
+
+    static std::optional<Key> key(const ir::Instruction &instruction);
+    static bool is_call(const ir::Instruction &instruction);
+
+    // Whether an instruction on some path between two positions stops the value of a key from being reused
+    bool clobbered(const Key &key, Position from, Position to);
+    static bool clobbers(const Key &key, const ir::Instruction &instruction);
+    const Effects &effects(int from, int to);
+};
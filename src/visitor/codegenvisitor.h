@@ -1,17 +1,22 @@
 #pragma once
-#include <stack>
+#include <algorithm>
+#include <optional>
+#include <unordered_map>
 
+#include "ir.h"
+#include "moon.h"
 #include "visitor.h"
 
-using std::endl;
-
+// Lowers the annotated AST of every function to three-address code, MoonEmitter writes the assembly from it
 class CodeGenVisitor : public Visitor {
-    std::ostream &output;
     std::ostream &error_output;
-    std::string indent = "\t";
-    std::stack<std::string> register_pool;
+    int free_registers = max_registers;
     int label_num = 0;
+    ir::Function *function = nullptr;
 
+    static constexpr int max_registers = 12; // r1 to r12
+    // The arguments passed in registers are all held at the call, along with its result
+    static_assert(ir::register_arguments < max_registers);
 
     void default_visit(AST *node) {
         for (auto child: node->children) {
@@ -23,13 +28,38 @@ class CodeGenVisitor : public Visitor {
         return name + std::to_string(label_num++);
     }
 
-    std::string pop() {
-        if (register_pool.empty()) {
+    // Values are kept in at most max_registers virtual registers at a time, so the emitter never runs out
+    ir::VReg pop() {
+        if (free_registers == 0) {
             throw std::runtime_error("No registers available");
         }
-        std::string reg = register_pool.top();
-        register_pool.pop();
-        return reg;
+        free_registers--;
+        return function->new_register();
+    }
+
+    void push(ir::VReg) {
+        free_registers++;
+    }
+
+    void emit(ir::Instruction instruction) {
+        if (function->blocks.back().terminated()) {
+            function->blocks.emplace_back();
+        }
+        function->blocks.back().instructions.push_back(std::move(instruction));
+    }
+
+    void comment(std::string text) {
+        emit({.op = ir::Opcode::COMMENT, .comment = std::move(text)});
+    }
+
+    // Following instructions go to a new block that jumps can target
+    void start_block(std::string label) {
+        auto &current = function->blocks.back();
+        if (current.instructions.empty() && current.label.empty()) {
+            current.label = std::move(label);
+        } else {
+            function->blocks.push_back({.label = std::move(label)});
+        }
     }
 
     void print_error(const int line_number, const std::string &message) {
@@ -37,237 +67,460 @@ class CodeGenVisitor : public Visitor {
         has_error = true;
     }
 
-public:
-    bool has_error = false;
-
-    explicit CodeGenVisitor(std::ostream &output, std::ostream &error_output) : output(output), error_output(error_output) {
-        for (int i = 12; i >= 1; --i) {
-            register_pool.push("r" + std::to_string(i));
+    // Registers needed to evaluate an expression without spilling, and whether it calls a function, which clobbers
+    // every register
+    struct Label {
+        int need = 1;
+        bool has_call = false;
+    };
+    std::unordered_map<const AST *, Label> labels;
+
+    static AST *skip_expr(AST *node) {
+        while (node->type == ASTType::EXPR) {
+            node = node->children[0];
         }
+        return node;
     }
 
-    void visitProgram(AST *node) override {
-        error_output << std::endl << "CodeGen Visitor errors:" << std::endl;
-        default_visit(node);
-        output << endl;
-        output << "% This is used for printing" << endl;
-        output << std::left << std::setw(10) << "buf" << "res 20" << endl;
+    static bool is_operation(const AST *node) {
+        return node->type == ASTType::ADDOP || node->type == ASTType::MULTOP || node->type == ASTType::RELOP;
     }
 
-    void visitFuncDef(AST *node) override {
-        output << "% Function: " << node->symbol_table->name << endl;
-        auto jump_symbol = node->symbol_table->find_child("jump", "jump");
-        assert(jump_symbol);
-        if (node->symbol_table->name == "main") {
-            output << "entry" << endl;
-            output << indent << "addi r14,r0,topaddr % Program starts here" << endl;
-        }
-        output << node->symbol_table->get_unique_name() << endl; // Label
-        output << indent << "sw " << jump_symbol->offset << "(r14), r15" << endl;
+    static bool is_unary(const AST *node) {
+        return node->type == ASTType::SIGN || node->type == ASTType::NOT;
+    }
 
-        default_visit(node);
+    // Operations and calls have a temporary of their own, other values are read from where they live
+    static bool has_temp(const AST *node) {
+        return is_operation(node) || is_unary(node) || node->type == ASTType::FUNCALL;
+    }
 
-        if (node->symbol_table->name == "main") {
-            output << indent << "hlt" << endl;
+    Label label(const AST *node) {
+        if (auto it = labels.find(node); it != labels.end()) {
+            return it->second;
         }
-        else {
-            output << indent << "lw r15," << jump_symbol->offset << "(r14)" << endl;
-            output << indent << "jr r15" << endl;
+        Label result;
+        result.has_call = node->type == ASTType::FUNCALL;
+        for (auto child: node->children) {
+            const Label child_label = label(child);
+            result.has_call |= child_label.has_call;
+            // Values read from memory may still compute something first, like an array index
+            result.need = std::max(result.need, child_label.need);
+        }
+        if (is_operation(node)) {
+            const int left = label(node->children[0]).need;
+            const int right = label(node->children[1]).need;
+            result.need = left == right ? left + 1 : std::max(left, right);
+            if (auto operand = immediate_form(node)) {
+                result.need = label(operand->reg).need;
+            }
         }
+        labels[node] = result;
+        return result;
     }
 
-    // TODO: set the variables to the current scope stack + offset then add the current scope offset to the stack pointer
-    void visitFunCall(AST *node) override {
-        assert(node->symbol->reference);
-        auto funcall = node->symbol->reference;
-        assert(funcall->subtable);
-        output << indent << "% Processing: function call to " << funcall->name << endl;
+    // A literal operand that fits the K field of the instruction is not loaded into a register
+    static std::optional<int> immediate(AST *node) {
+        node = skip_expr(node);
+        if (node->type != ASTType::INTLIT || !moon::fits_immediate(static_cast<ASTIntLit *>(node)->value)) {
+            return std::nullopt;
+        }
+        return static_cast<ASTIntLit *>(node)->value;
+    }
 
-        default_visit(node);
+    struct ImmediateForm {
+        AST *reg;        // Operand evaluated into a register
+        int value;
+        bool swapped;    // The literal is the left operand
+    };
 
-        auto return_symbol = funcall->subtable->find_child("return", "return");
-        assert(return_symbol);
-        auto reg = pop();
-        output << indent << "addi r14, r14," << node->symbol_table->size << endl;
-        output << indent << "jl r15," << funcall->subtable->get_unique_name() << endl;
-        if (node->symbol->type != "void") {
-            output << indent << "lw " << reg << "," << return_symbol->offset << "(r14)" << endl;
+    // Operations with a literal on the right, or on the left when swapping the operands keeps the meaning
+    static std::optional<ImmediateForm> immediate_form(const AST *node) {
+        if (auto value = immediate(node->children[1])) {
+            return ImmediateForm{node->children[0], *value, false};
+        }
+        const std::string &op = node->str_value.str();
+        if (op == "-" || op == "/") {
+            return std::nullopt;
+        }
+        if (auto value = immediate(node->children[0])) {
+            return ImmediateForm{node->children[1], *value, true};
         }
-        output << indent << "subi r14, r14," << node->symbol_table->size << endl;
-        output << indent << "sw " << node->symbol->offset << "(r14)," << reg << endl;
-        register_pool.push(reg);
+        return std::nullopt;
     }
 
-    void visitAParams(AST *node) override {
-        if (node->children.size() == 0) return;
-        default_visit(node);
-        assert(node->parent->type == ASTType::FUNCALL);
-        auto funcall = node->parent->symbol->reference;
-        const auto &funcall_symbols = funcall->subtable->symbols;
-
-        auto reg = pop();
-        int index = 0;
-        for (int i = 0; i < funcall_symbols.size(); i++) {
-            if (funcall_symbols[i]->kind == "param") {
-                auto param = node->children[index];
-                output << indent << "lw " << reg << "," << param->symbol->offset << "(r14)" << endl;
-                output << indent << "sw " << funcall_symbols[i]->offset + node->symbol_table->size << "(r14)," << reg << endl;
-                index++;
-            }
+    // x < 5 is 5 > x
+    static ir::Opcode swap_operands(ir::Opcode op) {
+        switch (op) {
+            case ir::Opcode::CLT: return ir::Opcode::CGT;
+            case ir::Opcode::CGT: return ir::Opcode::CLT;
+            case ir::Opcode::CLE: return ir::Opcode::CGE;
+            case ir::Opcode::CGE: return ir::Opcode::CLE;
+            default: return op;
         }
-        register_pool.push(reg);
     }
 
-    void visitAddOp(AST *node) override {
-        default_visit(node);
+    /**
+     * Evaluates an expression into a register, which the caller gives back to the pool. Operations are computed in
+     * registers, their operands are only stored in their temporaries when the registers run out or a call comes before
+     * they are used.
+     */
+    ir::VReg load(AST *node) {
+        node = skip_expr(node);
+        if (node->type == ASTType::INTLIT) {
+            const int value = static_cast<ASTIntLit *>(node)->value;
+            ir::VReg reg = pop();
+            comment("Processing: " + node->symbol->name.str() + " := " + std::to_string(value));
+            emit({.op = ir::Opcode::CONST, .dst = reg, .imm = value});
+            return reg;
+        }
+        if (is_operation(node)) {
+            return load_operation(node);
+        }
+        if (is_unary(node)) {
+            return load_unary(node);
+        }
+        if (node->type == ASTType::FUNCALL) {
+            return call(node);
+        }
+        visit(node);
+        ir::VReg reg = pop();
+        emit({.op = ir::Opcode::LOAD, .dst = reg, .imm = node->symbol->offset});
+        return reg;
+    }
+
+    // Sethi-Ullman order: the operand needing more registers goes first, unless the other one makes a call
+    ir::VReg load_operation(AST *node) {
         auto left_node = node->children[0];
         auto right_node = node->children[1];
         assert(node->symbol);
         assert(left_node->symbol);
         assert(right_node->symbol);
-        std::string reg1 = pop();
-        std::string reg2 = pop();
-        output << indent << "% Processing: " << node->symbol->name << " := " << left_node->symbol->name << ' ' << node->
-                str_value << ' ' << right_node->symbol->name << endl;
-        output << indent << "lw " << reg1 << "," << left_node->symbol->offset << "(r14)" << endl;
-        output << indent << "lw " << reg2 << "," << right_node->symbol->offset << "(r14)" << endl;
-        if (node->str_value == "+") {
-            output << indent << "add " << reg1 << "," << reg1 << "," << reg2 << endl;
-        } else if (node->str_value == "-") {
-            output << indent << "sub " << reg1 << "," << reg1 << "," << reg2 << endl;
-        } else {
-            throw std::runtime_error("Unknown operator: " + node->str_value);
+        if (auto operand = immediate_form(node)) {
+            ir::VReg reg = load(operand->reg);
+            comment("Processing: " + node->symbol->name.str() + " := " + left_node->symbol->name.str() + ' ' +
+                    node->str_value.str() + ' ' + right_node->symbol->name.str());
+            push(reg);
+            ir::VReg result = pop();
+            const ir::Opcode op = operand->swapped ? swap_operands(operation(node)) : operation(node);
+            emit({.op = op, .dst = result, .lhs = reg, .imm = operand->value});
+            return result;
+        }
+        const Label left = label(left_node);
+        const Label right = label(right_node);
+        bool left_first = left.need >= right.need;
+        if (left.has_call != right.has_call) {
+            left_first = left.has_call;
+        } else if (left.has_call) {
+            left_first = true; // Calls keep their order
+        }
+        AST *first = left_first ? left_node : right_node;
+        AST *second = left_first ? right_node : left_node;
+
+        ir::VReg first_reg = load(first);
+        const bool spill = label(second).has_call || free_registers < label(second).need;
+        if (spill) {
+            store(first, first_reg);
         }
-        output << indent << "sw " << node->symbol->offset << "(r14)," << reg1 << endl;
-        register_pool.push(reg1);
-        register_pool.push(reg2);
+        ir::VReg second_reg = load(second);
+        if (spill) {
+            first_reg = reload(first);
+        }
+        ir::VReg reg1 = left_first ? first_reg : second_reg;
+        ir::VReg reg2 = left_first ? second_reg : first_reg;
+
+        comment("Processing: " + node->symbol->name.str() + " := " + left_node->symbol->name.str() + ' ' +
+                node->str_value.str() + ' ' + right_node->symbol->name.str());
+        push(reg1);
+        push(reg2);
+        ir::VReg result = pop();
+        emit({.op = operation(node), .dst = result, .lhs = reg1, .rhs = reg2});
+        return result;
     }
 
-    void visitMultOp(AST *node) override {
-        default_visit(node);
-        auto left_node = node->children[0];
-        auto right_node = node->children[1];
+    // Negation multiplies by -1 and not compares with 0, the operand is the only register either needs
+    ir::VReg load_unary(AST *node) {
+        auto operand_node = node->children[0];
         assert(node->symbol);
-        assert(left_node->symbol);
-        assert(right_node->symbol);
-        std::string reg1 = pop();
-        std::string reg2 = pop();
-        output << indent << "% Processing: " << node->symbol->name << " := " << left_node->symbol->name << ' ' << node->
-                str_value << ' ' << right_node->symbol->name << endl;
-        output << indent << "lw " << reg1 << "," << left_node->symbol->offset << "(r14)" << endl;
-        output << indent << "lw " << reg2 << "," << right_node->symbol->offset << "(r14)" << endl;
-        if (node->str_value == "*") {
-            output << indent << "mul " << reg1 << "," << reg1 << "," << reg2 << endl;
-        } else if (node->str_value == "/") {
-            output << indent << "div " << reg1 << "," << reg1 << "," << reg2 << endl;
+        assert(operand_node->symbol);
+        ir::VReg reg = load(operand_node);
+        if (node->type == ASTType::SIGN && node->str_value.str() != "-") {
+            return reg;
+        }
+        comment("Processing: " + node->symbol->name.str() + " := " + node->str_value.str() + ' ' +
+                operand_node->symbol->name.str());
+        push(reg);
+        ir::VReg result = pop();
+        if (node->type == ASTType::NOT) {
+            emit({.op = ir::Opcode::CEQ, .dst = result, .lhs = reg, .imm = 0});
         } else {
-            throw std::runtime_error("Unknown operator: " + node->str_value);
+            emit({.op = ir::Opcode::MUL, .dst = result, .lhs = reg, .imm = -1});
         }
-        output << indent << "sw " << node->symbol->offset << "(r14)," << reg1 << endl;
-        register_pool.push(reg1);
-        register_pool.push(reg2);
+        return result;
     }
 
-    void visitRelop(AST *node) override {
-        default_visit(node);
-        auto left_node = node->children[0];
-        auto right_node = node->children[1];
-        assert(node->symbol);
-        assert(left_node->symbol);
-        assert(right_node->symbol);
-        std::string reg1 = pop();
-        std::string reg2 = pop();
-        output << indent << "% Processing: " << node->symbol->name << " := " << left_node->symbol->name << ' ' << node->
-                str_value << ' ' << right_node->symbol->name << endl;
-        output << indent << "lw " << reg1 << "," << left_node->symbol->offset << "(r14)" << endl;
-        output << indent << "lw " << reg2 << "," << right_node->symbol->offset << "(r14)" << endl;
-        if (node->str_value == "==") {
-            output << indent << "ceq " << reg1 << "," << reg1 << "," << reg2 << endl;
+    ir::Opcode operation(const AST *node) {
+        const std::string &op = node->str_value.str();
+        if (node->type == ASTType::ADDOP) {
+            if (op == "+") return ir::Opcode::ADD;
+            if (op == "-") return ir::Opcode::SUB;
+        } else if (node->type == ASTType::MULTOP) {
+            if (op == "*") return ir::Opcode::MUL;
+            if (op == "/") return ir::Opcode::DIV;
+        } else {
+            if (op == "==") return ir::Opcode::CEQ;
+            if (op == "<>") return ir::Opcode::CNE;
+            if (op == "<") return ir::Opcode::CLT;
+            if (op == ">") return ir::Opcode::CGT;
+            if (op == "<=") return ir::Opcode::CLE;
+            if (op == ">=") return ir::Opcode::CGE;
+        }
+        throw std::runtime_error("Unknown operator: " + op);
+    }
+
+    // Frees the register of a value that is needed again later, reload gets it back
+    void store(AST *node, ir::VReg reg) {
+        node = skip_expr(node);
+        if (has_temp(node)) {
+            emit({.op = ir::Opcode::STORE, .lhs = reg, .imm = node->symbol->offset});
+        }
+        push(reg);
+    }
+
+    ir::VReg reload(AST *node) {
+        node = skip_expr(node);
+        if (node->type == ASTType::INTLIT) {
+            return load(node);
         }
-        else if (node->str_value == "<>") {
-            output << indent << "cne " << reg1 << "," << reg1 << "," << reg2 << endl;
+        ir::VReg reg = pop();
+        emit({.op = ir::Opcode::LOAD, .dst = reg, .imm = node->symbol->offset});
+        return reg;
+    }
+
+    // Evaluates an expression into its temporary, for the nodes that read it from memory
+    void store_temp(AST *node) {
+        ir::VReg reg = load(node);
+        emit({.op = ir::Opcode::STORE, .lhs = reg, .imm = node->symbol->offset});
+        push(reg);
+    }
+
+    // Calls a function, the return value is left in a register, no_reg for void functions
+    ir::VReg call(AST *node) {
+        assert(node->symbol->reference);
+        auto funcall = node->symbol->reference;
+        assert(funcall->subtable);
+        comment("Processing: function call to " + funcall->name.str());
+
+        std::vector<ir::VReg> args;
+        for (auto child: node->children) {
+            if (child->type == ASTType::APARAMS) {
+                args = pass_arguments(child);
+            } else {
+                visit(child);
+            }
         }
-        else if (node->str_value == "<") {
-            output << indent << "clt " << reg1 << "," << reg1 << "," << reg2 << endl;
+
+        auto return_symbol = funcall->subtable->find_child(names::return_value, SymbolKind::RETURN);
+        assert(return_symbol);
+        ir::VReg reg = node->symbol->type != names::void_type ? pop() : ir::no_reg;
+        emit({.op = ir::Opcode::CALL, .dst = reg, .imm = return_symbol->offset, .frame = node->symbol_table->size,
+              .label = funcall->subtable->get_unique_name(), .args = args});
+        for (auto arg: args) {
+            push(arg);
         }
-        else if (node->str_value == ">") {
-            output << indent << "cgt " << reg1 << "," << reg1 << "," << reg2 << endl;
+        return reg;
+    }
+
+    // Parameters of a function that get their value in r1 and up, in that order
+    std::vector<Symbol *> register_params(const SymbolTable *table) const {
+        std::vector<Symbol *> params;
+        if (module.convention != ir::CallingConvention::REGISTERS) {
+            return params;
         }
-        else if (node->str_value == "<=") {
-            output << indent << "cle " << reg1 << "," << reg1 << "," << reg2 << endl;
+        for (auto symbol: table->symbols) {
+            if (params.size() < ir::register_arguments && symbol->kind == SymbolKind::PARAM &&
+                symbol->type == names::int_type) {
+                params.push_back(symbol);
+            }
         }
-        else if (node->str_value == ">=") {
-            output << indent << "cge " << reg1 << "," << reg1 << "," << reg2 << endl;
+        return params;
+    }
+
+    /**
+     * Copies the arguments to the parameter slots of the callee frame. The ones passed in registers are left in a
+     * register each, which the call gives back to the pool.
+     */
+    std::vector<ir::VReg> pass_arguments(AST *node) {
+        std::vector<ir::VReg> registers;
+        if (node->children.empty()) {
+            return registers;
         }
-        else {
-            throw std::runtime_error("Unknown operator: " + node->str_value);
+        assert(node->parent->type == ASTType::FUNCALL);
+        auto funcall = node->parent->symbol->reference;
+        const auto in_registers = register_params(funcall->subtable);
+
+        std::vector<std::pair<AST *, Symbol *>> arguments;
+        for (auto symbol: funcall->subtable->symbols) {
+            if (symbol->kind == SymbolKind::PARAM) {
+                arguments.emplace_back(node->children[arguments.size()], symbol);
+            }
+        }
+        auto in_register = [&](Symbol *param) {
+            return std::find(in_registers.begin(), in_registers.end(), param) != in_registers.end();
+        };
+
+        // Nested calls use the frame the arguments are copied to, so those arguments are evaluated beforehand. So are
+        // the ones going to a register that need more registers than are left once the earlier ones are held.
+        std::unordered_map<AST *, bool> evaluated;
+        int held = 0;
+        for (auto [argument, param]: arguments) {
+            const Label argument_label = label(argument);
+            const bool to_register = in_register(param);
+            if (argument_label.has_call || (to_register && argument_label.need > free_registers - held)) {
+                store(argument, load(argument));
+                evaluated[argument] = true;
+            }
+            held += to_register;
         }
-        output << indent << "sw " << node->symbol->offset << "(r14)," << reg1 << endl;
-        register_pool.push(reg1);
-        register_pool.push(reg2);
+        for (auto [argument, param]: arguments) {
+            if (in_register(param)) {
+                continue;
+            }
+            ir::VReg reg = evaluated[argument] ? reload(argument) : load(argument);
+            emit({.op = ir::Opcode::STORE, .lhs = reg, .imm = param->offset + node->symbol_table->size});
+            push(reg);
+        }
+        for (auto [argument, param]: arguments) {
+            if (in_register(param)) {
+                registers.push_back(evaluated[argument] ? reload(argument) : load(argument));
+            }
+        }
+        return registers;
     }
 
+    // Empty blocks may still hold empty lists of statements
+    static bool has_statements(const AST *block) {
+        return std::any_of(block->children.begin(), block->children.end(), [](const AST *child) {
+            return child->type != ASTType::STATEMENTS || has_statements(child);
+        });
+    }
 
-    void visit(ASTIntLit *node) override {
-        assert(node->symbol);
-        std::string reg = pop();
-        output << indent << "% Processing: " << node->symbol->name << " := " << node->value << endl;
-        output << indent << "addi " << reg << ",r0," << node->value << endl;
-        output << indent << "sw " << node->symbol->offset << "(r14)," << reg << endl;
-        register_pool.push(reg);
+    /**
+     * Jumps to a label when the condition is true, or when it is false, and falls through otherwise. A comparison with
+     * zero branches on the other operand directly.
+     */
+    void branch(AST *condition, bool when_true, std::string label) {
+        auto node = skip_expr(condition);
+        if (node->type == ASTType::RELOP && (node->str_value.str() == "==" || node->str_value.str() == "<>")) {
+            if (auto operand = immediate_form(node); operand && operand->value == 0) {
+                ir::VReg reg = load(operand->reg);
+                // x == 0 holds when x is zero, x <> 0 when it is not
+                const bool branch_on_zero = (node->str_value.str() == "==") == when_true;
+                emit({.op = branch_on_zero ? ir::Opcode::BRANCH_ZERO : ir::Opcode::BRANCH_NONZERO, .lhs = reg,
+                      .label = std::move(label)});
+                push(reg);
+                return;
+            }
+        }
+        ir::VReg reg = load(condition);
+        emit({.op = when_true ? ir::Opcode::BRANCH_NONZERO : ir::Opcode::BRANCH_ZERO, .lhs = reg,
+              .label = std::move(label)});
+        push(reg);
     }
 
-    void visitAssign(AST *node) override {
+public:
+    bool has_error = false;
+    ir::Module module;
+
+    explicit CodeGenVisitor(std::ostream &error_output,
+                            ir::CallingConvention convention = ir::CallingConvention::MEMORY) :
+        error_output(error_output) {
+        module.convention = convention;
+    }
+
+    void visitProgram(AST *node) override {
+        error_output << std::endl << "CodeGen Visitor errors:" << std::endl;
         default_visit(node);
+    }
+
+    void visitFuncDef(AST *node) override {
+        auto jump_symbol = node->symbol_table->find_child(names::return_address, SymbolKind::JUMP);
+        auto return_symbol = node->symbol_table->find_child(names::return_value, SymbolKind::RETURN);
+        assert(jump_symbol);
+        assert(return_symbol);
+        function = &module.functions.emplace_back();
+        function->name = node->symbol_table->name;
+        function->label = node->symbol_table->get_unique_name();
+        function->is_main = node->symbol_table->name == names::main_function;
+        function->return_address_offset = jump_symbol->offset;
+        function->return_value_offset = return_symbol->offset;
+        for (auto param: register_params(node->symbol_table)) {
+            function->register_params.push_back(param->offset);
+        }
+        function->blocks.emplace_back();
+
+        default_visit(node);
+
+        if (function->is_main) {
+            emit({.op = ir::Opcode::HALT});
+        }
+        else {
+            emit({.op = ir::Opcode::RETURN, .imm = jump_symbol->offset});
+        }
+        function = nullptr;
+    }
+
+    // TODO: set the variables to the current scope stack + offset then add the current scope offset to the stack pointer
+    void visitFunCall(AST *node) override {
+        ir::VReg reg = call(node);
+        // A void call has no value to keep
+        if (reg != ir::no_reg) {
+            emit({.op = ir::Opcode::STORE, .lhs = reg, .imm = node->symbol->offset});
+            push(reg);
+        }
+    }
+
+    // Arguments are passed by the call they belong to
+    void visitAParams(AST *node) override {}
+
+    void visitAddOp(AST *node) override { store_temp(node); }
+    void visitMultOp(AST *node) override { store_temp(node); }
+    void visitRelop(AST *node) override { store_temp(node); }
+    // Int literals are loaded as immediates by whichever node reads them, they are never kept in memory
+    void visit(ASTIntLit *node) override {}
+
+    void visitAssign(AST *node) override {
         auto left_node = node->children[0];
         auto right_node = node->children[1];
+        visit(left_node);
         assert(left_node->symbol);
         assert(right_node->symbol);
-        std::string reg = pop();
-        output << indent << "% Processing: " << left_node->symbol->name << " := " << right_node->symbol->name << endl;
-        output << indent << "lw " << reg << "," << right_node->symbol->offset << "(r14)" << endl;
-        output << indent << "sw " << left_node->symbol->offset << "(r14)," << reg << endl;
-        register_pool.push(reg);
+        ir::VReg reg = load(right_node);
+        comment("Processing: " + left_node->symbol->name.str() + " := " + right_node->symbol->name.str());
+        emit({.op = ir::Opcode::STORE, .lhs = reg, .imm = left_node->symbol->offset});
+        push(reg);
     }
 
     void visitWrite(AST *node) override {
-        default_visit(node);
-        if (node->children[0]->data_type != "int") {
+        if (node->children[0]->data_type != names::int_type) {
             print_error(node->line_number, "Write only supports int type");
         }
-        std::string reg1 = pop();
-        std::string reg2 = pop();
-        output << indent << "% Processing: write " << node->children[0]->symbol->name << endl;
-        output << indent << "lw " << reg1 << "," << node->children[0]->symbol->offset << "(r14)" << endl;
-        output << indent << "addi r14,r14," << node->symbol_table->size << endl;
-        output << indent << "sw -8(r14)," << reg1 << endl;
-        output << indent << "addi " << reg1 << ",r0, buf" << endl;
-        output << indent << "sw -12(r14)," << reg1 << endl;
-        output << indent << "jl r15, intstr" << endl;
-        output << indent << "sw -8(r14),r13" << endl;
-        output << indent << "jl r15, putstr" << endl;
-        output << indent << "subi r14,r14," << node->symbol_table->size << endl;
-        register_pool.push(reg1);
-        register_pool.push(reg2);
+        ir::VReg reg = load(node->children[0]);
+        comment("Processing: write " + node->children[0]->symbol->name.str());
+        emit({.op = ir::Opcode::WRITE, .lhs = reg, .frame = node->symbol_table->size});
+        push(reg);
     }
 
     void visitRead(AST *node) override {
         default_visit(node);
-        if (node->children[0]->data_type != "int") {
+        if (node->children[0]->data_type != names::int_type) {
             print_error(node->line_number, "Read only supports int type");
         }
-        std::string reg = pop();
-        output << indent << "% Processing: read " << node->children[0]->symbol->name << endl;
-        output << indent << "addi r14,r14," << node->symbol_table->size << endl;
-        output << indent << "addi " << reg << ",r0, buf" << endl;
-        output << indent << "sw -8(r14)," << reg << endl;
-        output << indent << "jl r15, getstr" << endl;
-        output << indent << "addi " << reg << ",r0, buf" << endl;
-        output << indent << "sw -8(r14)," << reg << endl;
-        output << indent << "jl r15, strint" << endl;
-        output << indent << "subi r14,r14," << node->symbol_table->size << endl;
-        output << indent << "sw " << node->children[0]->symbol->offset << "(r14),r13" << endl;
-        register_pool.push(reg);
+        ir::VReg reg = pop();
+        comment("Processing: read " + node->children[0]->symbol->name.str());
+        emit({.op = ir::Opcode::READ, .dst = reg, .imm = node->children[0]->symbol->offset,
+              .frame = node->symbol_table->size});
+        push(reg);
     }
 
     void visitIf(AST *node) override {
@@ -280,19 +533,25 @@ public:
         auto else_label = get_label("else");
         auto end_if_label = get_label("end_if");
 
-        std::string reg = pop();
-        output << indent << "% Processing: if statement" << endl;
-        visit(condition);
-        output << indent << "lw " << reg << "," << condition->symbol->offset << "(r14)" << endl;
-        output << indent << "bz " << reg << "," << else_label << endl;
-        visit(then_block);
-        output << indent << "j " << end_if_label << endl;
-        output << else_label << endl;
-        visit(else_block);
-        output << end_if_label << endl;
-        register_pool.push(reg);
+        comment("Processing: if statement");
+        if (!has_statements(then_block)) {
+            // Only the else branch does something, it is skipped when the condition holds
+            branch(condition, true, end_if_label);
+            visit(else_block);
+        } else if (!has_statements(else_block)) {
+            branch(condition, false, end_if_label);
+            visit(then_block);
+        } else {
+            branch(condition, false, else_label);
+            visit(then_block);
+            emit({.op = ir::Opcode::JUMP, .label = end_if_label});
+            start_block(else_label);
+            visit(else_block);
+        }
+        start_block(end_if_label);
     }
 
+    // The test is at the bottom of the loop, each iteration takes a single branch back to the body
     void visitWhile(AST *node) override {
         assert(node->children.size() == 2);
         auto condition = node->children[0];
@@ -300,34 +559,31 @@ public:
         assert(condition->symbol);
 
         auto while_label = get_label("while");
-        auto end_while_label = get_label("end_while");
-
-        std::string reg = pop();
-        output << indent << "% Processing: while loop" << endl;
-        output << while_label << endl;
-        visit(condition);
-        output << indent << "lw " << reg << "," << condition->symbol->offset << "(r14)" << endl;
-        output << indent << "bz " << reg << "," << end_while_label << endl;
+        auto while_test_label = get_label("while_test");
+
+        comment("Processing: while loop");
+        emit({.op = ir::Opcode::JUMP, .label = while_test_label});
+        start_block(while_label);
         visit(then_block);
-        output << indent << "j " << while_label << endl;
-        output << end_while_label << endl;
-        register_pool.push(reg);
+        start_block(while_test_label);
+        branch(condition, true, while_label);
     }
 
     void visitReturn(AST *node) override {
-        default_visit(node);
-        const auto jump_symbol = node->symbol_table->find_child("jump", "jump");
-        const auto return_symbol = node->symbol_table->find_child("return", "return");
+        const auto jump_symbol = node->symbol_table->find_child(names::return_address, SymbolKind::JUMP);
+        const auto return_symbol = node->symbol_table->find_child(names::return_value, SymbolKind::RETURN);
         const auto child = node->children[0]->symbol;
         assert(jump_symbol);
         assert(return_symbol);
-        auto reg = pop();
-        output << indent << "% Processing: return " << child->name << endl;
-        output << indent << "lw " << reg << "," << child->offset << "(r14)" << endl;
-        output << indent << "sw " << return_symbol->offset << "(r14)," << reg << endl;
-        output << indent << "lw r15," << jump_symbol->offset << "(r14)" << endl;
-        output << indent << "jr r15" << endl;
-        register_pool.push(reg);
+        ir::VReg reg = load(node->children[0]);
+        comment("Processing: return " + child->name.str());
+        if (module.convention == ir::CallingConvention::REGISTERS) {
+            emit({.op = ir::Opcode::RETURN, .lhs = reg, .imm = jump_symbol->offset});
+        } else {
+            emit({.op = ir::Opcode::STORE, .lhs = reg, .imm = return_symbol->offset});
+            emit({.op = ir::Opcode::RETURN, .imm = jump_symbol->offset});
+        }
+        push(reg);
     }
 
     void visitFParam(AST *node) override { default_visit(node); }
@@ -346,9 +602,9 @@ public:
     void visitVarDecl(AST *node) override { default_visit(node); }
     void visitFuncBody(AST *node) override { default_visit(node); }
     void visitStatement(AST *node) override { default_visit(node); }
-    void visitSign(AST *node) override { default_visit(node); }
+    void visitSign(AST *node) override { store_temp(node); }
     void visitFactor(AST *node) override { default_visit(node); }
-    void visitNot(AST *node) override { default_visit(node); }
+    void visitNot(AST *node) override { store_temp(node); }
     void visitStatblock(AST *node) override { default_visit(node); }
     void visitStatements(AST *node) override { default_visit(node); }
     void visitSelf(AST *node) override { default_visit(node); }
@@ -0,0 +1,282 @@
+#pragma once
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "context.h"
+#include "moon.h"
+#include "visitor.h"
+
+/**
+ * Folds operators over int literals into a single literal and replaces the reads of int locals whose value is known,
+ * so the code generator loads an immediate instead of computing the value at runtime. Runs between the semantic checks
+ * and MemSizeVisitor, the temporaries of folded operations are gone before the frames are laid out.
+ *
+ * Known values follow the statements of a function body in order. Both branches of an if start from the values known
+ * before it and only the ones they agree on are kept afterwards. Variables assigned in a loop are unknown in all of it.
+ */
+class ConstFoldVisitor : public Visitor {
+    CompilationContext &context;
+    std::unordered_map<Symbol*, int> constants;
+    // Literals merged into a folded one, removed from the table of their function afterwards
+    std::unordered_set<Symbol*> removed;
+    int literal_num = 0;
+
+    void default_visit(AST* node) {
+        for (auto child: node->children) {
+            visit(child);
+        }
+    }
+
+    static AST* skip_expr(AST* node) {
+        while (node->type == ASTType::EXPR) {
+            node = node->children[0];
+        }
+        return node;
+    }
+
+    static std::optional<int> constant(AST* node) {
+        node = skip_expr(node);
+        if (node->type != ASTType::INTLIT) {
+            return std::nullopt;
+        }
+        return static_cast<ASTIntLit*>(node)->value;
+    }
+
+    static std::optional<long long> evaluate(AST* node, long long left, long long right) {
+        const std::string &op = node->str_value.str();
+        if (op == "+") return left + right;
+        if (op == "-") return left - right;
+        if (op == "*") return left * right;
+        if (op == "/") {
+            // Division by zero is left to fail at runtime, MOON truncates towards zero like C++
+            if (right == 0) return std::nullopt;
+            return left / right;
+        }
+        if (op == "and") return left != 0 && right != 0;
+        if (op == "or") return left != 0 || right != 0;
+        if (op == "==") return left == right;
+        if (op == "<>") return left != right;
+        if (op == "<") return left < right;
+        if (op == ">") return left > right;
+        if (op == "<=") return left <= right;
+        if (op == ">=") return left >= right;
+        return std::nullopt;
+    }
+
+    // A scalar int local or parameter of the function, the only variables whose value can be tracked
+    static Symbol* tracked_variable(AST* node) {
+        if (node->type == ASTType::VARIABLE) {
+            node = node->children[0];
+        }
+        if (node->type != ASTType::DATAMEMBER || node->children.size() < 2 || !node->children[1]->children.empty()) {
+            return nullptr;
+        }
+        auto symbol = node->symbol;
+        if (symbol == nullptr || symbol->type != names::int_type ||
+            (symbol->kind != SymbolKind::LOCAL && symbol->kind != SymbolKind::PARAM)) {
+            return nullptr;
+        }
+        return symbol;
+    }
+
+    /**
+     * Puts a literal in the place of a node
+     * @param symbol temporary of the node reused by the literal, a new one is made when it is nullptr
+     */
+    void replace(AST* node, long long value, Symbol* symbol) {
+        auto old_symbol = node->symbol;
+        if (symbol == nullptr) {
+            symbol = context.arena.make<Symbol>(SymbolKind::LIT, names::int_type,
+                                                Name("const" + std::to_string(literal_num++)));
+            node->symbol_table->add_entry(symbol);
+        }
+        symbol->kind = SymbolKind::LIT;
+        symbol->type = names::int_type;
+
+        auto literal = context.arena.make<ASTIntLit>(static_cast<int>(value), node->line_number);
+        literal->symbol_table = node->symbol_table;
+        literal->symbol = symbol;
+        literal->data_type = names::int_type;
+        auto parent = node->parent;
+        parent->replace(node, literal);
+        // Expressions pass the symbol and type of their value on to their parent
+        while (parent != nullptr && parent->type == ASTType::EXPR && parent->symbol == old_symbol) {
+            parent->symbol = symbol;
+            parent->data_type = names::int_type;
+            parent = parent->parent;
+        }
+    }
+
+    void fold_operation(AST* node) {
+        default_visit(node);
+        auto left = constant(node->children[0]);
+        auto right = constant(node->children[1]);
+        if (!left || !right || node->symbol == nullptr) {
+            return;
+        }
+        auto value = evaluate(node, *left, *right);
+        // Literals are loaded with an addi, larger values stay computed at runtime
+        if (!value || !moon::fits_immediate(*value)) {
+            return;
+        }
+        removed.insert(skip_expr(node->children[0])->symbol);
+        removed.insert(skip_expr(node->children[1])->symbol);
+        replace(node, *value, node->symbol);
+        folded++;
+    }
+
+    void fold_unary(AST* node, bool is_not) {
+        default_visit(node);
+        auto operand = constant(node->children[0]);
+        if (!operand) {
+            return;
+        }
+        long long value = *operand;
+        if (is_not) {
+            value = value == 0;
+        } else if (node->str_value.str() == "-") {
+            value = -value;
+        }
+        if (!moon::fits_immediate(value)) {
+            return;
+        }
+        removed.insert(skip_expr(node->children[0])->symbol);
+        replace(node, value, node->symbol);
+        folded++;
+    }
+
+    // The target of an assignment or read is written, only the expressions in it, like indices, are folded
+    void visit_target(AST* node) {
+        if (node->type == ASTType::VARIABLE) {
+            visit_target(node->children[0]);
+            return;
+        }
+        default_visit(node);
+    }
+
+    // Variables given a value anywhere below node
+    static void assigned_variables(AST* node, std::unordered_set<Symbol*> &variables) {
+        if ((node->type == ASTType::ASSIGN || node->type == ASTType::READ) && node->children[0]->symbol) {
+            variables.insert(node->children[0]->symbol);
+        }
+        for (auto child: node->children) {
+            assigned_variables(child, variables);
+        }
+    }
+
+public:
+    // Operators folded and variable reads replaced by their value
+    int folded = 0;
+    int propagated = 0;
+
+    explicit ConstFoldVisitor(CompilationContext &context) : context(context) {}
+
+    void visitFuncBody(AST* node) override {
+        constants.clear();
+        removed.clear();
+        default_visit(node);
+        node->symbol_table->remove_entries(removed);
+        constants.clear();
+    }
+
+    void visitAddOp(AST* node) override { fold_operation(node); }
+    void visitMultOp(AST* node) override { fold_operation(node); }
+    void visitRelop(AST* node) override { fold_operation(node); }
+    void visitSign(AST* node) override { fold_unary(node, false); }
+    void visitNot(AST* node) override { fold_unary(node, true); }
+
+    void visitDataMember(AST* node) override {
+        default_visit(node);
+        auto variable = tracked_variable(node);
+        if (variable == nullptr) {
+            return;
+        }
+        if (auto it = constants.find(variable); it != constants.end()) {
+            replace(node, it->second, nullptr);
+            propagated++;
+        }
+    }
+
+    void visitAssign(AST* node) override {
+        auto left_node = node->children[0];
+        visit_target(left_node);
+        visit(node->children[1]);
+        if (auto variable = tracked_variable(left_node)) {
+            if (auto value = constant(node->children[1])) {
+                constants[variable] = *value;
+            } else {
+                constants.erase(variable);
+            }
+        }
+    }
+
+    void visitRead(AST* node) override {
+        visit_target(node->children[0]);
+        constants.erase(node->children[0]->symbol);
+    }
+
+    void visitIf(AST* node) override {
+        assert(node->children.size() == 3);
+        visit(node->children[0]);
+        const auto before = constants;
+        visit(node->children[1]);
+        auto then_constants = std::move(constants);
+        constants = before;
+        visit(node->children[2]);
+        std::erase_if(constants, [&](const auto &entry) {
+            auto it = then_constants.find(entry.first);
+            return it == then_constants.end() || it->second != entry.second;
+        });
+    }
+
+    void visitWhile(AST* node) override {
+        std::unordered_set<Symbol*> variables;
+        assigned_variables(node, variables);
+        for (auto variable: variables) {
+            constants.erase(variable);
+        }
+        const auto before = constants;
+        default_visit(node);
+        // The body may run any number of times, only what held before the loop still holds
+        constants = before;
+    }
+
+    void visitProgram(AST* node) override { default_visit(node); }
+    void visitClassDef(AST* node) override {}
+    void visitIsa(AST* node) override {}
+    void visitImplDef(AST* node) override { default_visit(node); }
+    void visitMembers(AST* node) override {}
+    void visitVisibility(AST* node) override {}
+    void visitFuncHead(AST* node) override {}
+    void visitConstructor(AST* node) override {}
+    void visitClassMember(AST* node) override {}
+    void visitImplBody(AST* node) override { default_visit(node); }
+    void visitFuncDef(AST* node) override { default_visit(node); }
+    void visitFParams(AST* node) override {}
+    void visitFParam(AST* node) override {}
+    void visitType(AST* node) override {}
+    void visitArraySizes(AST* node) override {}
+    void visitArraySize(AST* node) override {}
+    void visitVarDecl(AST* node) override {}
+    void visitStatement(AST* node) override { default_visit(node); }
+    void visitFactor(AST* node) override { default_visit(node); }
+    void visitStatblock(AST* node) override { default_visit(node); }
+    void visitStatements(AST* node) override { default_visit(node); }
+    void visitSelf(AST* node) override {}
+    void visitAParams(AST* node) override { default_visit(node); }
+    void visitFunCall(AST* node) override { default_visit(node); }
+    void visitExpr(AST* node) override { default_visit(node); }
+    void visitDot(AST* node) override { default_visit(node); }
+    void visitIndices(AST* node) override { default_visit(node); }
+    void visitVariable(AST* node) override { default_visit(node); }
+    void visitIndice(AST* node) override { default_visit(node); }
+    void visitWrite(AST* node) override { default_visit(node); }
+    void visitReturn(AST* node) override { default_visit(node); }
+    void visitVarOrFunCall(AST* node) override { default_visit(node); }
+    void visitTerm(AST* node) override { default_visit(node); }
+    void visitId(AST* node) override {}
+    void visit(ASTIntLit* node) override {}
+    void visit(ASTFloatLit* node) override {}
+    void visit(AST* node) override { Visitor::visit(node); }
+};
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <algorithm>
+#include <climits>
 #include <set>
+#include <unordered_map>
 
 #include "visitor.h"
 
@@ -16,18 +19,126 @@ class MemSizeVisitor : public Visitor {
         }
     }
 
-    int get_size(const std::string& type) {
+    int get_size(Name type) {
         assert(root_node);
-        if (type == "int") return 4;
-        if (type == "float") return 8;
-        if (type == "void") return 0;
-        if (const auto class_symbol = root_node->symbol_table->find_child(type, "class")) {
+        if (type == names::int_type) return 4;
+        if (type == names::float_type) return 8;
+        if (type == names::void_type) return 0;
+        if (const auto class_symbol = root_node->symbol_table->find_child(type, SymbolKind::CLASS)) {
             return class_symbol->subtable->size;
         }
         return 0;
     }
 
-    std::set<std::string> var_types = { "data", "param", "local" };
+    std::set<SymbolKind> var_types = { SymbolKind::DATA, SymbolKind::PARAM, SymbolKind::LOCAL };
+
+    // Lays out the members of a class once their sizes are known
+    void size_class(AST* node) {
+        assert(node->symbol_table);
+        assert(as_class_table(node->symbol_table));
+        for (auto symbol : node->symbol_table->symbols) {
+            if (symbol) {
+                symbol->offset = node->symbol_table->size - symbol->size;
+                node->symbol_table->size -= symbol->size;
+            }
+        }
+    }
+
+    // Positions in the postorder of a function body between which the value of a temporary has to be kept
+    struct LiveRange {
+        int start = -1;
+        int end = -1;
+    };
+
+    static bool is_temp(const Symbol* symbol) {
+        return symbol && (symbol->kind == SymbolKind::TEMP || symbol->kind == SymbolKind::LIT);
+    }
+
+    /**
+     * Numbers the nodes in postorder, the order in which the code generator visits them. A temporary is live from the
+     * first node that carries it up to the first ancestor that does not, which is the one reading it. The code
+     * generator may evaluate the operands of that ancestor in any order and spill them in between, so the range also
+     * covers the whole subtree of the reader.
+     * @param ranges the temporaries to track, the others are ignored
+     */
+    void find_live_ranges(AST* node, int &position, std::unordered_map<Symbol*, LiveRange> &ranges) {
+        const int first = position;
+        for (auto child : node->children) {
+            find_live_ranges(child, position, ranges);
+        }
+        const int here = position++;
+        if (auto it = ranges.find(node->symbol); it != ranges.end() && it->second.start < 0) {
+            it->second = {here, here};
+        }
+        for (auto child : node->children) {
+            if (child->symbol == node->symbol) {
+                continue;
+            }
+            if (auto it = ranges.find(child->symbol); it != ranges.end()) {
+                it->second.start = std::min(it->second.start, first);
+                it->second.end = std::max(it->second.end, here);
+            }
+        }
+    }
+
+    // Lays out the frame of a function once the sizes of its locals and temporaries are known
+    void size_frame(AST* node) {
+        assert(node->symbol_table);
+        auto table = node->symbol_table;
+        std::unordered_map<Symbol*, LiveRange> ranges;
+        std::vector<Symbol*> temps;
+        int unshared_size = 0;
+        for (auto symbol : table->symbols) {
+            if (!symbol) {
+                continue;
+            }
+            symbol->calculate_size();
+            // The code generator loads int literals as immediates, they do not need a slot
+            if (symbol->kind == SymbolKind::LIT && symbol->type == names::int_type) {
+                symbol->size = 0;
+                continue;
+            }
+            unshared_size -= symbol->size;
+            if (is_temp(symbol)) {
+                ranges.emplace(symbol, LiveRange{});
+                temps.push_back(symbol);
+                continue;
+            }
+            symbol->offset = table->size - symbol->size;
+            table->size -= symbol->size;
+        }
+
+        int position = 0;
+        find_live_ranges(node, position, ranges);
+        std::stable_sort(temps.begin(), temps.end(), [&](Symbol* a, Symbol* b) {
+            return ranges[a].start < ranges[b].start;
+        });
+
+        // Temporaries whose ranges do not overlap share a slot of the same size
+        struct Slot {
+            int offset;
+            int size;
+            int end;
+        };
+        std::vector<Slot> slots;
+        for (auto symbol : temps) {
+            const auto &range = ranges[symbol];
+            // The result of a void call is still stored, so it needs a word of its own as well
+            const int size = std::max(symbol->size, 4);
+            auto slot = std::find_if(slots.begin(), slots.end(), [&](const Slot &slot) {
+                return range.start >= 0 && slot.size == size && slot.end < range.start;
+            });
+            if (slot == slots.end()) {
+                table->size -= size;
+                slots.push_back({table->size, size, range.end});
+                slot = slots.end() - 1;
+            }
+            // Temporaries never seen in the body keep their slot to themselves
+            slot->end = range.start >= 0 ? range.end : INT_MAX;
+            symbol->offset = slot->offset;
+        }
+        table->unshared_size = unshared_size;
+    }
 
 public:
     MemSizeVisitor() = default;
@@ -38,27 +149,13 @@ public:
     }
 
     void visitClassDef(AST* node) override {
-        assert(node->symbol_table);
-        assert(std::dynamic_pointer_cast<ClassSymbolTable>(node->symbol_table));
         default_visit(node);
-        for (auto symbol : node->symbol_table->symbols) {
-            if (symbol) {
-                symbol->offset = node->symbol_table->size - symbol->size;
-                node->symbol_table->size -= symbol->size;
-            }
-        }
+        size_class(node);
     }
 
     void visitFuncBody(AST* node) override {
-        assert(node->symbol_table);
         default_visit(node);
-        for (auto symbol : node->symbol_table->symbols) {
-            if (symbol) {
-                symbol->calculate_size();
-                symbol->offset = node->symbol_table->size - symbol->size;
-                node->symbol_table->size -= symbol->size;
-            }
-        }
+        size_frame(node);
     }
 
     void visitMultOp(AST* node) override {
@@ -117,9 +214,19 @@ public:
     void visitArraySizes(AST* node) override {}
     void visitArraySize(AST* node) override {}
     void visitStatement(AST* node) override { default_visit(node); }
-    void visitSign(AST* node) override { default_visit(node); }
+    void visitSign(AST* node) override {
+        default_visit(node);
+        if (node->symbol) {
+            node->symbol->calculate_size();
+        }
+    }
     void visitFactor(AST* node) override { default_visit(node); }
-    void visitNot(AST* node) override { default_visit(node); }
+    void visitNot(AST* node) override {
+        default_visit(node);
+        if (node->symbol) {
+            node->symbol->calculate_size();
+        }
+    }
     void visitStatblock(AST* node) override { default_visit(node); }
     void visitIf(AST* node) override { default_visit(node); }
     void visitStatements(AST* node) override { default_visit(node); }
@@ -1,10 +1,12 @@
 #pragma once
 #include <functional>
 
+#include "context.h"
 #include "symtable.h"
 #include "visitor.h"
 
 class SemanticVisitor : public Visitor {
+    CompilationContext &context;
     std::ostream &error_output;
     SymbolTable *root_table = nullptr;
     int temp_var_num = 0;
@@ -15,8 +17,8 @@ class SemanticVisitor : public Visitor {
         }
     }
 
-    std::string generate_temp_var(const std::string &prefix = "temp") {
-        return prefix + std::to_string(temp_var_num++);
+    Name generate_temp_var(const std::string &prefix = "temp") {
+        return Name(prefix + std::to_string(temp_var_num++));
     }
 
 
@@ -33,26 +35,27 @@ class SemanticVisitor : public Visitor {
 public:
     bool has_error = false;
 
-    explicit SemanticVisitor(std::ostream &error_output) : error_output(error_output) {}
+    SemanticVisitor(CompilationContext &context, std::ostream &error_output) : context(context),
+        error_output(error_output) {}
 
     void visitProgram(AST* node) override {
         assert(node->symbol_table);
         error_output << std::endl << "Semantic Visitor errors:" << std::endl;
-        root_table = node->symbol_table.get();
+        root_table = node->symbol_table;
         default_visit(node);
     }
 
     void visitClassDef(AST* node) override {
         default_visit(node);
-        auto class_table = std::dynamic_pointer_cast<ClassSymbolTable, SymbolTable>(node->symbol_table);
+        auto class_table = as_class_table(node->symbol_table);
         if (!class_table) {
             return;
         }
         for (auto symbol : class_table->symbols) {
-            if (symbol->kind == "data") {
+            if (symbol->kind == SymbolKind::DATA) {
                 for (auto parent : class_table->parents) {
-                    if (auto parent_symbol = parent->find_child(symbol->name, "data")) {
-                        print_warning(node->line_number, "Symbol " + symbol->name + " shadows parent symbol " + parent_symbol->name + " in class " + parent->name);
+                    if (auto parent_symbol = parent->find_child(symbol->name, SymbolKind::DATA)) {
+                        print_warning(node->line_number, "Symbol " + symbol->name.str() + " shadows parent symbol " + parent_symbol->name.str() + " in class " + parent->name.str());
                     }
                 }
             }
@@ -62,20 +65,20 @@ public:
     void visitIsa(AST* node) override {
         if (!node->symbol_table) return;
 
-        std::string classname = node->symbol_table->name;
-        auto this_table = std::dynamic_pointer_cast<ClassSymbolTable, SymbolTable>(node->symbol_table);
+        Name classname = node->symbol_table->name;
+        auto this_table = as_class_table(node->symbol_table);
 
         for (auto child : node->children) {
             auto class_table = find_class_table(child->str_value);
             if (class_table == nullptr) {
-                print_error(node->line_number, "Class " + child->str_value + " not defined");
+                print_error(node->line_number, "Class " + child->str_value.str() + " not defined");
                 continue;
             }
             this_table->parents.push_back(class_table);
         }
-        std::unordered_set<std::string> visited;
+        std::unordered_set<Name> visited;
         if (dfs(this_table, classname, visited)) {
-            print_error(node->line_number, "Circular dependency detected in class " + classname);
+            print_error(node->line_number, "Circular dependency detected in class " + classname.str());
             this_table->parents.clear(); // Removing them to avoid infinite loops
         }
     }
@@ -86,12 +89,12 @@ public:
     void visitFuncHead(AST* node) override {
         if (!node->symbol) return;
 
-        auto func_symbol = std::dynamic_pointer_cast<FuncSymbol>(node->symbol);
+        auto func_symbol = symbol_cast<FuncSymbol>(node->symbol);
         if (!func_symbol->declared) {
-            print_error(node->line_number, "Function " + func_symbol->name + " not declared");
+            print_error(node->line_number, "Function " + func_symbol->name.str() + " not declared");
         }
         if (!func_symbol->defined) {
-            print_error(node->line_number, "Function " + func_symbol->name + " not defined");
+            print_error(node->line_number, "Function " + func_symbol->name.str() + " not defined");
         }
     }
     void visitFuncBody(AST* node) override { default_visit(node); }
@@ -108,17 +111,16 @@ public:
     void visitVarDecl(AST* node) override {
         default_visit(node);
         auto type = node->children[1]->str_value;
-        if (type != "int" && type != "float") {
+        if (type != names::int_type && type != names::float_type) {
             auto class_table = find_class_table(type);
             if (class_table == nullptr) {
-                print_error(node->line_number, "Type " + type + " not defined");
+                print_error(node->line_number, "Type " + type.str() + " not defined");
                 return;
             }
         }
         assert(node->symbol);
         auto arraysizes = node->children[2];
         for (auto & size : arraysizes->children) {
-            type += "[]";
             if (size->children.size() != 1) {
                 print_error(node->line_number, "All arrays must have a size");
                 continue;
@@ -143,9 +145,23 @@ public:
         default_visit(node);
         assert(node->children.size() == 1);
         node->data_type = node->children[0]->data_type;
+        add_unary_temp(node, "sign");
     }
     void visitFactor(AST* node) override { default_visit(node); }
-    void visitNot(AST* node) override { default_visit(node); }
+    void visitNot(AST* node) override {
+        default_visit(node);
+        assert(node->children.size() == 1);
+        node->data_type = node->children[0]->data_type;
+        add_unary_temp(node, "not");
+    }
+
+    // The value of a unary operator on an int, like the one of a binary operator, has a temporary of its own
+    void add_unary_temp(AST* node, const std::string &prefix) {
+        if (node->data_type == names::int_type) {
+            node->symbol = make<Symbol>(SymbolKind::TEMP, names::int_type, generate_temp_var(prefix));
+            node->symbol_table->add_entry(node->symbol);
+        }
+    }
     void visitStatblock(AST* node) override { default_visit(node); }
     void visitIf(AST* node) override { default_visit(node); }
     void visitStatements(AST* node) override { default_visit(node); }
@@ -163,70 +179,70 @@ public:
         else {
             default_visit(node);
         }
-        std::vector<std::string> params;
+        std::vector<Name> params;
         for (auto &param: node->children[1]->children) {
-            if (param->data_type == "type_error") {
-                node->data_type = "type_error";
+            if (param->data_type == names::type_error) {
+                node->data_type = names::type_error;
                 return;
             }
             params.push_back(param->data_type);
         }
 
-        auto symbol = std::make_shared<Symbol>("temp", "", generate_temp_var("func_call"));
+        auto symbol = make<Symbol>(SymbolKind::TEMP, Name(), generate_temp_var("func_call"));
         node->symbol = symbol;
         node->symbol_table->add_entry(symbol);
 
         if (first_child->type == ASTType::ID) {
             auto func = root_table->find_func_child(first_child->str_value, params);
             if (!func) {
-                func = std::dynamic_pointer_cast<FuncSymbol, Symbol>(root_table->find_child(first_child->str_value, "function"));
+                func = symbol_cast<FuncSymbol>(root_table->find_child(first_child->str_value, SymbolKind::FUNCTION));
                 if (func == nullptr)
-                    print_error(node->line_number, "Function " + first_child->str_value + " does not exist");
+                    print_error(node->line_number, "Function " + first_child->str_value.str() + " does not exist");
                 else
-                   print_error(node->line_number, "Function " + first_child->str_value + " called with incorrect parameters");
-                node->data_type = "type_error";
+                   print_error(node->line_number, "Function " + first_child->str_value.str() + " called with incorrect parameters");
+                node->data_type = names::type_error;
                 return;
             }
             symbol->type = func->type;
             node->data_type = func->type;
-            symbol->reference = func.get();
+            symbol->reference = func;
         }
         else if (first_child->type == ASTType::DOT) {
-            if (first_child->data_type == "type_error") {
-                node->data_type = "type_error";
+            if (first_child->data_type == names::type_error) {
+                node->data_type = names::type_error;
                 return;
             }
             assert(first_child->children[0]);
             assert(first_child->children[1]);
             auto left_type = first_child->children[0]->data_type;
-            if (left_type == "type_error") {
+            if (left_type == names::type_error) {
                 return;
             }
-            if (left_type == "int" || left_type == "float") {
-                node->data_type = "type_error";
-                print_error(node->line_number, "Cannot use dot operator on type " + left_type);
+            if (left_type == names::int_type || left_type == names::float_type) {
+                node->data_type = names::type_error;
+                print_error(node->line_number, "Cannot use dot operator on type " + left_type.str());
                 return;
             }
             auto class_table = find_class_table(left_type);
             if (class_table == nullptr) {
-                node->data_type = "type_error";
-                print_error(node->line_number, "Class " + left_type + " not defined");
+                node->data_type = names::type_error;
+                print_error(node->line_number, "Class " + left_type.str() + " not defined");
                 return;
             }
-            auto func = std::dynamic_pointer_cast<Symbol, FuncSymbol>(class_table->find_func_child(first_child->children[1]->str_value, params));
+            Symbol *func = class_table->find_func_child(first_child->children[1]->str_value, params);
             if (func == nullptr) {
-                func = class_table->find_child(first_child->children[1]->str_value, "method");
+                func = class_table->find_child(first_child->children[1]->str_value, SymbolKind::METHOD);
                 if (func == nullptr) {
-                    print_error(node->line_number, "Method " + first_child->children[1]->str_value + " does not exist in class " + class_table->name);
+                    print_error(node->line_number, "Method " + first_child->children[1]->str_value.str() + " does not exist in class " + class_table->name.str());
                 }
                 else {
-                    print_error(node->line_number, "Method " + first_child->children[1]->str_value + " called with incorrect parameters (" + vector_to_string(params) + ')');
-                    node->data_type = "type_error";
+                    print_error(node->line_number, "Method " + first_child->children[1]->str_value.str() + " called with incorrect parameters (" + vector_to_string(params) + ')');
+                    node->data_type = names::type_error;
                 }
-                node->data_type = "type_error";
+                node->data_type = names::type_error;
                 return;
             }
-            node->symbol->reference = func.get();
+            node->symbol->reference = func;
             node->symbol->type = func->type;
             node->data_type = func->type;
         }
@@ -234,7 +250,7 @@ public:
 
     void visitExpr(AST* node) override {
         default_visit(node);
-        std::string child_type = node->children[0]->data_type;
+        Name child_type = node->children[0]->data_type;
         assert(!child_type.empty());
         node->data_type = child_type;
         node->symbol = node->children[0]->symbol;
@@ -242,36 +258,36 @@ public:
 
     void visitDot(AST* node) override {
         default_visit(node);
-        const std::string left_type = node->children[0]->data_type;
+        const Name left_type = node->children[0]->data_type;
         assert(node->parent);
         assert(!left_type.empty());
-        if (left_type == "type_error") {
-            node->data_type = "type_error";
+        if (left_type == names::type_error) {
+            node->data_type = names::type_error;
             return;
         }
-        if (left_type == "int" || left_type == "float") {
-            node->data_type = "type_error";
-            print_error(node->line_number, "Cannot use dot operator on type " + left_type);
+        if (left_type == names::int_type || left_type == names::float_type) {
+            node->data_type = names::type_error;
+            print_error(node->line_number, "Cannot use dot operator on type " + left_type.str());
             return;
         }
 
         // Find the class table of the left side
         auto class_table = find_class_table(left_type);
         if (class_table == nullptr) {
-            node->data_type = "type_error";
-            print_error(node->line_number, "Class " + left_type + " not defined");
+            node->data_type = names::type_error;
+            print_error(node->line_number, "Class " + left_type.str() + " not defined");
             return;
         }
 
-        const std::string right_name = node->children[1]->str_value;
+        const Name right_name = node->children[1]->str_value;
         const auto symbol = class_table->find_child(right_name);
         if (symbol == nullptr) {
-            node->data_type = "type_error";
+            node->data_type = names::type_error;
             if (node->parent->type == ASTType::FUNCALL) {
-                print_error(node->line_number, "Function " + right_name + " not defined");
+                print_error(node->line_number, "Function " + right_name.str() + " not defined");
             }
             else {
-                print_error(node->line_number, "Data member " + right_name + " not defined " + left_type);
+                print_error(node->line_number, "Data member " + right_name.str() + " not defined " + left_type.str());
             }
             return;
         }
@@ -284,17 +300,17 @@ public:
         default_visit(node);
         if (node->children.size() != 0) {
             // This will be used to store the address of the index
-            node->symbol = std::make_shared<Symbol>("temp", "int", generate_temp_var("indices"));
+            node->symbol = make<Symbol>(SymbolKind::TEMP, names::int_type, generate_temp_var("indices"));
             node->symbol_table->add_entry(node->symbol);
         }
         for (auto &child: node->children) {
-            if (child->data_type == "type_error") {
-                node->data_type = "type_error";
+            if (child->data_type == names::type_error) {
+                node->data_type = names::type_error;
                 return;
             }
-            if (child->data_type != "int") {
-                node->data_type = "type_error";
-                print_error(node->line_number, "Indices type error: expected int, found " + child->data_type);
+            if (child->data_type != names::int_type) {
+                node->data_type = names::type_error;
+                print_error(node->line_number, "Indices type error: expected int, found " + child->data_type.str());
                 return;
             }
         }
@@ -302,25 +318,25 @@ public:
 
     void visitAssign(AST* node) override {
         default_visit(node);
-        std::string left_type = node->children[0]->data_type;
-        std::string right_type = node->children[1]->data_type;
+        Name left_type = node->children[0]->data_type;
+        Name right_type = node->children[1]->data_type;
         assert(!left_type.empty());
         // assert(!right_type.empty());
         if (left_type == right_type) {
             node->data_type = left_type;
         }
         else {
-            if (left_type == "type_error" || right_type == "type_error") {
-                node->data_type = "type_error";
+            if (left_type == names::type_error || right_type == names::type_error) {
+                node->data_type = names::type_error;
                 return;
             }
-            node->data_type = "type_error";
-            print_error(node->line_number, "Assign type error: " + left_type + " := " + right_type);
+            node->data_type = names::type_error;
+            print_error(node->line_number, "Assign type error: " + left_type.str() + " := " + right_type.str());
         }
     }
     void visitVariable(AST* node) override {
         default_visit(node);
-        std::string child_type = node->children[0]->data_type;
+        Name child_type = node->children[0]->data_type;
         assert(!child_type.empty());
         node->data_type = child_type;
         node->symbol = node->children[0]->symbol;
@@ -338,23 +354,22 @@ public:
         }
         auto symbol = node->symbol_table->lookup(node->children[0]->str_value);
         if (symbol == nullptr) {
-            node->data_type = "type_error";
-            print_error(node->line_number, "Identifier " + node->children[0]->str_value + " not defined");
+            node->data_type = names::type_error;
+            print_error(node->line_number, "Identifier " + node->children[0]->str_value.str() + " not defined");
             return;
         }
-        node->data_type = symbol->type;
         node->symbol = symbol;
-        // Check for array access
+        // Check for array access, each index strips one [] from the type
+        std::string_view type = symbol->type.str();
         for (int i = 0; i < node->children[1]->children.size(); i++) {
-            if (node->data_type.back() != ']') {
-                node->data_type = "type_error";
-                print_error(node->line_number, "Identifier " + node->children[0]->str_value + " incorrect depth");
+            if (!type.ends_with("[]")) {
+                node->data_type = names::type_error;
+                print_error(node->line_number, "Identifier " + node->children[0]->str_value.str() + " incorrect depth");
                 return;
             }
-            node->data_type.pop_back();
-            assert(node->data_type.back() == '[');
-            node->data_type.pop_back();
+            type.remove_suffix(2);
         }
+        node->data_type = Name(type);
     }
 
     void visitRead(AST* node) override { default_visit(node); }
@@ -364,60 +379,60 @@ public:
 
     void visitMultOp(AST* node) override {
         default_visit(node);
-        std::string left_type = node->children[0]->data_type;
-        std::string right_type = node->children[1]->data_type;
+        Name left_type = node->children[0]->data_type;
+        Name right_type = node->children[1]->data_type;
 
         assert(!left_type.empty());
         assert(!right_type.empty());
 
         if (left_type == right_type) {
             node->data_type = left_type;
-            if (left_type == "int" || left_type == "float") {
-                auto symbol = std::make_shared<Symbol>("temp", left_type, generate_temp_var("mult"));
+            if (left_type == names::int_type || left_type == names::float_type) {
+                auto symbol = make<Symbol>(SymbolKind::TEMP, left_type, generate_temp_var("mult"));
                 symbol->calculate_size();
                 node->symbol_table->add_entry(symbol);
                 node->symbol = symbol;
             }
         }
         else {
-            if (left_type == "type_error" || right_type == "type_error") {
-                node->data_type = "type_error";
+            if (left_type == names::type_error || right_type == names::type_error) {
+                node->data_type = names::type_error;
                 return;
             }
-            node->data_type = "type_error";
-            print_error(node->line_number, "Multop type error: " + left_type + " * " + right_type);
+            node->data_type = names::type_error;
+            print_error(node->line_number, "Multop type error: " + left_type.str() + " * " + right_type.str());
         }
     }
 
     void visitAddOp(AST* node) override {
         default_visit(node);
-        std::string left_type = node->children[0]->data_type;
-        std::string right_type = node->children[1]->data_type;
+        Name left_type = node->children[0]->data_type;
+        Name right_type = node->children[1]->data_type;
 
         assert(!left_type.empty());
         assert(!right_type.empty());
 
         if (left_type == right_type) {
             node->data_type = left_type;
-            if (left_type == "int" || left_type == "float") {
-                auto symbol = std::make_shared<Symbol>("temp", left_type, generate_temp_var("add"));
+            if (left_type == names::int_type || left_type == names::float_type) {
+                auto symbol = make<Symbol>(SymbolKind::TEMP, left_type, generate_temp_var("add"));
                 node->symbol_table->add_entry(symbol);
                 node->symbol = symbol;
             }
         }
         else {
-            if (left_type == "type_error" || right_type == "type_error") {
-                node->data_type = "type_error";
+            if (left_type == names::type_error || right_type == names::type_error) {
+                node->data_type = names::type_error;
                 return;
             }
-            node->data_type = "type_error";
-            print_error(node->line_number, "AddOp type error: " + left_type + " + " + right_type);
+            node->data_type = names::type_error;
+            print_error(node->line_number, "AddOp type error: " + left_type.str() + " + " + right_type.str());
         }
     }
 
     void visitRelop(AST* node) override {
         default_visit(node);
-        node->symbol = std::make_shared<Symbol>("temp", "bool", generate_temp_var("relop"));
+        node->symbol = make<Symbol>(SymbolKind::TEMP, names::bool_type, generate_temp_var("relop"));
         node->symbol_table->add_entry(node->symbol);
     }
 
@@ -425,47 +440,53 @@ public:
     void visitId(AST* node) override { default_visit(node); }
 
     void visit(ASTIntLit* node) override {
-        node->data_type = "int";
-        node->symbol = std::make_shared<Symbol>("lit", "int", generate_temp_var("intlit"));
+        node->data_type = names::int_type;
+        node->symbol = make<Symbol>(SymbolKind::LIT, names::int_type, generate_temp_var("intlit"));
         node->symbol_table->add_entry(node->symbol);
 
     }
     void visit(ASTFloatLit* node) override {
-        node->data_type = "float";
+        node->data_type = names::float_type;
     }
 
     void visit(AST* node) override { Visitor::visit(node); }
 
 private:
+    // Allocates a symbol in the arena of the compilation
+    template<typename T, typename... Args>
+    T *make(Args &&... args) {
+        return context.arena.make<T>(std::forward<Args>(args)...);
+    }
+
     // Find a class table from the root
-    shared_ptr<ClassSymbolTable> find_class_table(const std::string &name) {
+    ClassSymbolTable *find_class_table(Name name) {
         assert(root_table);
         auto symbol = root_table->find_child(name);
         if (symbol == nullptr) {
             return nullptr;
         }
-        return std::static_pointer_cast<ClassSymbolTable, SymbolTable>(symbol->subtable);
+        return as_class_table(symbol->subtable);
     }
 
     // Get function params from it's FParams node vector
-    std::vector<std::string> get_func_params(const AST* node) {
-        std::vector<std::string> params;
+    std::vector<Name> get_func_params(const AST* node) {
+        std::vector<Name> params;
         for (auto param: node->children) {
-            std::string param_type = param->children[1]->str_value;
+            std::string param_type = param->children[1]->str_value.str();
             for (int i = 0; i < param->children[2]->children.size(); i++) {
                 param_type += "[]";
             }
-            params.push_back(param_type);
+            params.emplace_back(param_type);
         }
         return params;
     }
 
-    bool symbol_exists(const std::string &name, const SymbolTable *table) {
+    bool symbol_exists(Name name, const SymbolTable *table) {
         return table->find_child(name) != nullptr;
     }
 
     // Depth first search to avoid circular dependencies in inheritance using a set to keep track of visited nodes
-    bool dfs(const std::shared_ptr<ClassSymbolTable>& class_table, const std::string &original_name, std::unordered_set<std::string> &visited) {
+    bool dfs(const ClassSymbolTable *class_table, Name original_name, std::unordered_set<Name> &visited) {
         if (visited.contains(class_table->name)) {
             return false;
         }
@@ -482,10 +503,10 @@ private:
     }
 
     // std::vector<std::string> to string function
-    static std::string vector_to_string(const std::vector<std::string>& vec) {
+    static std::string vector_to_string(const std::vector<Name>& vec) {
         std::string result;
-        for (const auto& str : vec) {
-            result += str + " ";
+        for (const auto& name : vec) {
+            result += name.str() + " ";
         }
         return result;
     }
@@ -1,12 +1,14 @@
 #pragma once
+#include "context.h"
 #include "visitor.h"
 
 
 // Creates the symbol table for all AST nodes
 class SymTableVisitor : public Visitor {
+    CompilationContext &context;
     std::ostream &error_output;
     SymbolTable *root_table = nullptr;
-    std::shared_ptr<Symbol> error_symbol = std::make_shared<Symbol>("error", "error", "error");
+    Symbol *error_symbol;
 
     void default_visit(AST* node) {
         for (auto child: node->children) {
@@ -23,11 +25,12 @@ class SymTableVisitor : public Visitor {
 public:
     bool has_error = false;
 
-    explicit SymTableVisitor(std::ostream &error_output) : error_output(error_output) {}
+    SymTableVisitor(CompilationContext &context, std::ostream &error_output) : context(context),
+        error_output(error_output), error_symbol(make<Symbol>(SymbolKind::ERROR, Name("error"), Name("error"))) {}
 
     void visitProgram(AST* node) override {
-        node->symbol_table = std::make_shared<SymbolTable>(0, "global");
-        root_table = node->symbol_table.get();
+        node->symbol_table = make<SymbolTable>(0, names::global);
+        root_table = node->symbol_table;
         error_output << std::endl << "SymTable Visitor errors:" << std::endl;
 
         for (auto child: node->children) {
@@ -35,27 +38,27 @@ public:
             visit(child);
         }
 
-        if (node->symbol_table->find_child("main", "function") == nullptr) {
+        if (node->symbol_table->find_child(names::main_function, SymbolKind::FUNCTION) == nullptr) {
             print_error(node->line_number, "No main function found");
         }
     }
 
     void visitClassDef(AST* node) override {
-        std::string classname = node->children[0]->str_value;
+        Name classname = node->children[0]->str_value;
         auto class_table = find_class_table(classname);
         if (class_table) {
             if (class_table->declared) {
-                print_error(node->line_number, "Class " + classname + " already declared");
+                print_error(node->line_number, "Class " + classname.str() + " already declared");
                 return;
             }
         }
         else {
-            if (symbol_exists(classname, node->symbol_table.get())) {
-                print_error(node->line_number, "Symbol " + classname + " already exists");
+            if (symbol_exists(classname, node->symbol_table)) {
+                print_error(node->line_number, "Symbol " + classname.str() + " already exists");
                 return;
             }
-            class_table = std::make_shared<ClassSymbolTable>(node->symbol_table->level + 1, classname, node->symbol_table.get());
-            node->symbol = std::make_shared<Symbol>("class", classname, classname, std::dynamic_pointer_cast<SymbolTable, ClassSymbolTable>(class_table));
+            class_table = make<ClassSymbolTable>(node->symbol_table->level + 1, classname, node->symbol_table);
+            node->symbol = make<Symbol>(SymbolKind::CLASS, classname, classname, class_table);
             node->symbol_table->add_entry(node->symbol);
         }
 
@@ -74,12 +77,12 @@ public:
         auto classname = node->children[0]->str_value;
         auto class_table = find_class_table(classname);
         if (class_table == nullptr) {
-            class_table = std::make_shared<ClassSymbolTable>(node->symbol_table->level + 1, classname, node->symbol_table.get());
-            node->symbol = std::make_shared<Symbol>("class", classname, classname, std::dynamic_pointer_cast<SymbolTable, ClassSymbolTable>(class_table));
+            class_table = make<ClassSymbolTable>(node->symbol_table->level + 1, classname, node->symbol_table);
+            node->symbol = make<Symbol>(SymbolKind::CLASS, classname, classname, class_table);
             node->symbol_table->add_entry(node->symbol);
         }
         else if (class_table->implemented) {
-            print_error(node->line_number, "Class " + classname + " already implemented");
+            print_error(node->line_number, "Class " + classname.str() + " already implemented");
             return;
         }
         node->symbol_table = class_table;
@@ -98,34 +101,34 @@ public:
         auto type = node->children[2];
         auto name = node->children[0]->str_value;
         const auto params = node->children[1];
-        std::vector<std::string> param_types = get_func_params(params);
-        shared_ptr<FuncSymbol> func_symbol = node->symbol_table->find_func_child(name, param_types);
+        std::vector<Name> param_types = get_func_params(params);
+        FuncSymbol *func_symbol = node->symbol_table->find_func_child(name, param_types);
 
         if (func_symbol) {
             if (node->next && node->next->type == ASTType::FUNCBODY) {
                 if (func_symbol->defined) {
-                    print_error(node->line_number, "Function " + name + " already defined");
+                    print_error(node->line_number, "Function " + name.str() + " already defined");
                     return;
                 }
             }
             else {
                 if (func_symbol->declared) {
-                    print_error(node->line_number, "Function " + name + " already declared");
+                    print_error(node->line_number, "Function " + name.str() + " already declared");
                     return;
                 }
-                func_symbol->is_public = node->firstSibling->str_value == "public";
+                func_symbol->is_public = node->firstSibling->str_value == names::visibility_public;
                 func_symbol->declared = true;
                 return; // We don't need to do anything other than mark the function as declared and public/private
             }
         }
         else if (auto symbol = node->symbol_table->find_child(name)) {
-            print_error(node->line_number, ": Warning: Function " + name + " overloaded");
+            print_error(node->line_number, ": Warning: Function " + name.str() + " overloaded");
         }
 
         // This is a free function
-        if (node->symbol_table->name == "global") {
-            auto symbol_table = std::make_shared<SymbolTable>(node->symbol_table->level + 1, name, node->symbol_table.get());
-            auto symbol = std::make_shared<FuncSymbol>("function", type->str_value, name, param_types, true, symbol_table);
+        if (node->symbol_table->name == names::global) {
+            auto symbol_table = make<SymbolTable>(node->symbol_table->level + 1, name, node->symbol_table);
+            auto symbol = make<FuncSymbol>(SymbolKind::FUNCTION, type->str_value, name, param_types, true, symbol_table);
             node->symbol_table->add_entry(symbol);
             node->parent->symbol_table = symbol_table;
             node->symbol_table = symbol_table;
@@ -136,8 +139,8 @@ public:
         // Class members
         else if (node->parent->type == ASTType::CLASSMEM) {
             assert(!func_symbol);
-            bool visibility = node->firstSibling->str_value == "public";
-            func_symbol = std::make_shared<FuncSymbol>("method", type->str_value, name, param_types, visibility);
+            bool visibility = node->firstSibling->str_value == names::visibility_public;
+            func_symbol = make<FuncSymbol>(SymbolKind::METHOD, type->str_value, name, param_types, visibility);
             node->symbol_table->add_entry(func_symbol);
             node->symbol = func_symbol;
             func_symbol->declared = true;
@@ -145,19 +148,19 @@ public:
         }
         else if (node->parent->parent->type == ASTType::IMPLBODY) {
             if (!func_symbol) {
-                func_symbol = std::make_shared<FuncSymbol>("method", type->str_value, name, param_types);
+                func_symbol = make<FuncSymbol>(SymbolKind::METHOD, type->str_value, name, param_types);
                 node->symbol_table->add_entry(func_symbol);
                 node->symbol = func_symbol;
             }
-            auto func_table = std::make_shared<SymbolTable>(node->symbol_table->level + 1, name, node->symbol_table.get());
+            auto func_table = make<SymbolTable>(node->symbol_table->level + 1, name, node->symbol_table);
             func_symbol->subtable = func_table;
             node->symbol_table = func_table;
             node->parent->symbol_table = func_table;
             func_symbol->defined = true;
         }
 
-        auto return_symbol = std::make_shared<Symbol>("return", type->str_value, "return");
-        auto jump_symbol = std::make_shared<Symbol>("jump", "int", "jump");
+        auto return_symbol = make<Symbol>(SymbolKind::RETURN, type->str_value, names::return_value);
+        auto jump_symbol = make<Symbol>(SymbolKind::JUMP, names::int_type, names::return_address);
         node->symbol_table->add_entry(return_symbol);
         node->symbol_table->add_entry(jump_symbol);
 
@@ -175,11 +178,11 @@ public:
     void visitFParams(AST* node) override { default_visit(node); }
     void visitFParam(AST* node) override {
         auto name = node->children[0]->str_value;
-        auto type = node->children[1]->str_value;
+        auto type = node->children[1]->str_value.str();
         for (int i = 0; i < node->children[2]->children.size(); i++) {
             type += "[]";
         }
-        auto symbol = std::make_shared<Symbol>("param", type, name);
+        auto symbol = make<Symbol>(SymbolKind::PARAM, Name(type), name);
         node->symbol_table->add_entry(symbol);
         node->symbol = symbol;
     }
@@ -191,27 +194,27 @@ public:
         default_visit(node);
         assert(node->parent && node->parent->parent);
         auto name = node->children[0]->str_value;
-        auto type = node->children[1]->str_value;
+        auto type = node->children[1]->str_value.str();
         std::vector<int> dimensions;
         for (int i = 0; i < node->children[2]->children.size(); i++) {
             type += "[]";
         }
 
-        if (symbol_exists(name, node->symbol_table.get())) {
-            print_error(node->line_number, "Variable " + name + " already exists");
+        if (symbol_exists(name, node->symbol_table)) {
+            print_error(node->line_number, "Variable " + name.str() + " already exists");
             node->symbol = error_symbol;
             return;
         }
 
         if (node->parent->type == ASTType::CLASSMEM) { // This checks if it's a class member
-            bool is_public = node->firstSibling->str_value == "public";
-            auto symbol = std::make_shared<VarSymbol>("data", type, name, is_public);
+            bool is_public = node->firstSibling->str_value == names::visibility_public;
+            auto symbol = make<VarSymbol>(SymbolKind::DATA, Name(type), name, is_public);
             node->symbol_table->add_entry(symbol);
             node->symbol = symbol;
             node->parent->symbol = symbol;
         }
         else {
-            auto symbol = std::make_shared<Symbol>("local", type, name);
+            auto symbol = make<Symbol>(SymbolKind::LOCAL, Name(type), name);
             node->symbol_table->add_entry(symbol);
             node->symbol = symbol;
         }
@@ -250,30 +253,36 @@ public:
     void visit(AST* node) override { Visitor::visit(node); }
 
 private:
+    // Allocates a symbol or a table in the arena of the compilation
+    template<typename T, typename... Args>
+    T *make(Args &&... args) {
+        return context.arena.make<T>(std::forward<Args>(args)...);
+    }
+
     // Find a class table from the root
-    shared_ptr<ClassSymbolTable> find_class_table(const std::string &name) {
+    ClassSymbolTable *find_class_table(Name name) {
         assert(root_table);
         auto symbol = root_table->find_child(name);
         if (symbol == nullptr) {
             return nullptr;
         }
-        return std::static_pointer_cast<ClassSymbolTable, SymbolTable>(symbol->subtable);
+        return as_class_table(symbol->subtable);
     }
 
     // Get function params from it's FParams node vector
-    std::vector<std::string> get_func_params(const AST* node) {
-        std::vector<std::string> params;
+    std::vector<Name> get_func_params(const AST* node) {
+        std::vector<Name> params;
         for (auto param: node->children) {
-            std::string param_type = param->children[1]->str_value;
+            std::string param_type = param->children[1]->str_value.str();
             for (int i = 0; i < param->children[2]->children.size(); i++) {
                 param_type += "[]";
             }
-            params.push_back(param_type);
+            params.emplace_back(param_type);
         }
         return params;
     }
 
-    bool symbol_exists(const std::string &name, const SymbolTable *table) {
+    bool symbol_exists(Name name, const SymbolTable *table) {
         return table->find_child(name) != nullptr;
     }
 };
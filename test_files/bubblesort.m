@@ -0,0 +1,202 @@
+% Function: bubbleSort
+g_bubbleSort_arr_size
+	sw -4(r14),r15
+	lw r1,-12(r14)
+	% Processing: n := size
+	% Processing: intlit0 := 0
+	addi r2,r0,0
+	% Processing: i := intlit0
+	sw -20(r14),r2
+	% Processing: intlit1 := 0
+	% Processing: j := intlit1
+	sw -24(r14),r2
+	% Processing: intlit2 := 0
+	% Processing: temp := intlit2
+	% Processing: while loop
+	subi r2,r1,1
+	j while_test1
+while0
+	% Processing: while loop
+	sub r4,r1,r3
+	subi r4,r4,1
+	j while_test3
+while2
+	% Processing: if statement
+	lw r6,-8(r14)
+	% Processing: add12 := j + intlit11
+	addi r7,r5,1
+	% Processing: relop14 := arr > arr
+	cgt r8,r6,r6
+	bz r8,end_if5
+	% Processing: temp := arr
+	% Processing: add18 := j + intlit17
+	% Processing: arr := arr
+	% Processing: add21 := j + intlit20
+	% Processing: arr := temp
+	sw -8(r14),r6
+end_if5
+	% Processing: add24 := j + intlit23
+	% Processing: j := add24
+	sw -24(r14),r7
+while_test3
+	% Processing: add6 := n - i
+	% Processing: add8 := add6 - intlit7
+	lw r5,-24(r14)
+	% Processing: relop9 := j < add8
+	clt r7,r5,r4
+	bnz r7,while2
+	% Processing: add26 := i + intlit25
+	addi r7,r3,1
+	% Processing: i := add26
+	sw -20(r14),r7
+while_test1
+	lw r3,-20(r14)
+	% Processing: add4 := n - intlit3
+	% Processing: relop5 := i < add4
+	clt r7,r3,r2
+	bnz r7,while0
+	lw r15,-4(r14)
+	jr r15
+% Function: printArray
+g_printArray_arr_size
+	sw -4(r14),r15
+	lw r1,-12(r14)
+	% Processing: n := size
+	sw -16(r14),r1
+	% Processing: intlit27 := 0
+	addi r1,r0,0
+	% Processing: i := intlit27
+	sw -20(r14),r1
+	% Processing: while loop
+	j while_test7
+while6
+	lw r1,-8(r14)
+	% Processing: write arr
+	addi r14,r14,-28
+	sw -8(r14),r1
+	addi r1,r0,buf
+	sw -12(r14),r1
+	jl r15,intstr
+	sw -8(r14),r13
+	jl r15,putstr
+	subi r14,r14,-28
+	lw r1,-20(r14)
+	% Processing: add31 := i + intlit30
+	addi r1,r1,1
+	% Processing: i := add31
+	sw -20(r14),r1
+while_test7
+	lw r1,-20(r14)
+	lw r2,-16(r14)
+	% Processing: relop28 := i < n
+	clt r1,r1,r2
+	bnz r1,while6
+	lw r15,-4(r14)
+	jr r15
+% Function: main
+entry
+	addi r14,r0,topaddr % Program starts here
+g_main
+	sw -4(r14),r15
+	% Processing: intlit34 := 64
+	% Processing: arr := intlit34
+	% Processing: intlit37 := 34
+	% Processing: arr := intlit37
+	% Processing: intlit40 := 25
+	% Processing: arr := intlit40
+	% Processing: intlit43 := 12
+	% Processing: arr := intlit43
+	% Processing: intlit46 := 22
+	% Processing: arr := intlit46
+	% Processing: intlit49 := 11
+	% Processing: arr := intlit49
+	% Processing: intlit52 := 90
+	addi r1,r0,90
+	% Processing: arr := intlit52
+	sw -32(r14),r1
+	% Processing: function call to printArray
+	sw -44(r14),r1
+	% Processing: intlit53 := 7
+	addi r1,r0,7
+	% Inlined call to printArray
+	% Processing: n := size
+	sw -52(r14),r1
+	% Processing: intlit27 := 0
+	addi r1,r0,0
+	% Processing: i := intlit27
+	sw -56(r14),r1
+	% Processing: while loop
+	j while_test7_0
+while6_0
+	lw r1,-44(r14)
+	% Processing: write arr
+	addi r14,r14,-64
+	sw -8(r14),r1
+	addi r1,r0,buf
+	sw -12(r14),r1
+	jl r15,intstr
+	sw -8(r14),r13
+	jl r15,putstr
+	subi r14,r14,-64
+	lw r1,-56(r14)
+	% Processing: add31 := i + intlit30
+	addi r1,r1,1
+	% Processing: i := add31
+	sw -56(r14),r1
+while_test7_0
+	lw r1,-56(r14)
+	lw r2,-52(r14)
+	% Processing: relop28 := i < n
+	clt r1,r1,r2
+	bnz r1,while6_0
+inline_0
+	% Processing: function call to bubbleSort
+	lw r1,-32(r14)
+	sw -44(r14),r1
+	% Processing: intlit55 := 7
+	addi r1,r0,7
+	sw -48(r14),r1
+	addi r14,r14,-36
+	jl r15,g_bubbleSort_arr_size
+	subi r14,r14,-36
+	% Processing: function call to printArray
+	lw r1,-32(r14)
+	sw -44(r14),r1
+	% Processing: intlit57 := 7
+	addi r1,r0,7
+	% Inlined call to printArray
+	% Processing: n := size
+	sw -52(r14),r1
+	% Processing: intlit27 := 0
+	addi r1,r0,0
+	% Processing: i := intlit27
+	sw -56(r14),r1
+	% Processing: while loop
+	j while_test7_1
+while6_1
+	lw r1,-44(r14)
+	% Processing: write arr
+	addi r14,r14,-64
+	sw -8(r14),r1
+	addi r1,r0,buf
+	sw -12(r14),r1
+	jl r15,intstr
+	sw -8(r14),r13
+	jl r15,putstr
+	subi r14,r14,-64
+	lw r1,-56(r14)
+	% Processing: add31 := i + intlit30
+	addi r1,r1,1
+	% Processing: i := add31
+	sw -56(r14),r1
+while_test7_1
+	lw r1,-56(r14)
+	lw r2,-52(r14)
+	% Processing: relop28 := i < n
+	clt r1,r1,r2
+	bnz r1,while6_1
+inline_1
+	hlt
+
+% This is used for printing
+buf       res 20
@@ -0,0 +1,292 @@
+% Function: f
+g_f_a_b_c_d_e_g
+	sw -8(r14),r15
+	lw r1,-12(r14)
+	% Processing: mult1 := a * intlit0
+	muli r1,r1,1000
+	% Processing: mult3 := mult1 / intlit2
+	divi r1,r1,1000
+	lw r2,-16(r14)
+	% Processing: mult5 := b * intlit4
+	muli r2,r2,2
+	% Processing: add6 := mult3 - mult5
+	sub r1,r1,r2
+	lw r2,-20(r14)
+	% Processing: mult8 := c * intlit7
+	muli r2,r2,3
+	% Processing: add9 := add6 + mult8
+	add r1,r1,r2
+	lw r2,-24(r14)
+	% Processing: mult11 := d * intlit10
+	muli r2,r2,4
+	% Processing: add12 := add9 - mult11
+	sub r1,r1,r2
+	lw r2,-28(r14)
+	% Processing: mult14 := e * intlit13
+	muli r2,r2,5
+	% Processing: add15 := add12 + mult14
+	add r1,r1,r2
+	lw r2,-32(r14)
+	% Processing: mult17 := g * intlit16
+	muli r2,r2,6
+	% Processing: add18 := add15 - mult17
+	sub r1,r1,r2
+	% Processing: return add18
+	sw -4(r14),r1
+	lw r15,-8(r14)
+	jr r15
+% Function: h
+g_h_a_b
+	sw -8(r14),r15
+	lw r1,-12(r14)
+	lw r2,-16(r14)
+	% Processing: add19 := a - b
+	sub r1,r1,r2
+	% Processing: return add19
+	sw -4(r14),r1
+	lw r15,-8(r14)
+	jr r15
+% Function: k
+g_k_arr_x
+	sw -8(r14),r15
+	lw r1,-16(r14)
+	% Processing: add21 := x + intlit20
+	addi r1,r1,1
+	% Processing: return add21
+	sw -4(r14),r1
+	lw r15,-8(r14)
+	jr r15
+% Function: main
+entry
+	addi r14,r0,topaddr % Program starts here
+g_main
+	sw -4(r14),r15
+	% Processing: read x
+	addi r14,r14,-48
+	addi r1,r0,buf
+	sw -8(r14),r1
+	jl r15,getstr
+	addi r1,r0,buf
+	sw -8(r14),r1
+	jl r15,strint
+	subi r14,r14,-48
+	sw -8(r14),r13
+	addi r1,r13,0
+	% Processing: add23 := x + intlit22
+	addi r2,r1,1
+	% Processing: y := add23
+	sw -12(r14),r2
+	% Processing: function call to h
+	sw -60(r14),r1
+	sw -64(r14),r2
+	% Inlined call to h
+	% Processing: add19 := a - b
+	sub r1,r1,r2
+	% Processing: return add19
+	sw -52(r14),r1
+inline_0
+	% Processing: write func_call24
+	addi r14,r14,-48
+	sw -8(r14),r1
+	addi r1,r0,buf
+	sw -12(r14),r1
+	jl r15,intstr
+	sw -8(r14),r13
+	jl r15,putstr
+	subi r14,r14,-48
+	% Processing: function call to h
+	lw r1,-12(r14)
+	sw -60(r14),r1
+	lw r2,-8(r14)
+	sw -64(r14),r2
+	% Inlined call to h
+	% Processing: add19 := a - b
+	sub r1,r1,r2
+	% Processing: return add19
+	sw -52(r14),r1
+inline_1
+	% Processing: write func_call25
+	addi r14,r14,-48
+	sw -8(r14),r1
+	addi r1,r0,buf
+	sw -12(r14),r1
+	jl r15,intstr
+	sw -8(r14),r13
+	jl r15,putstr
+	subi r14,r14,-48
+	% Processing: function call to h
+	% Processing: function call to h
+	lw r1,-8(r14)
+	lw r2,-12(r14)
+	% Inlined call to h
+	% Processing: add19 := a - b
+	sub r3,r1,r2
+	% Processing: return add19
+inline_2
+	% Processing: function call to h
+	% Inlined call to h
+	% Processing: add19 := a - b
+	sub r2,r2,r1
+	% Processing: return add19
+inline_3
+	sw -60(r14),r3
+	sw -64(r14),r2
+	% Inlined call to h
+	% Processing: add19 := a - b
+	sub r3,r3,r2
+	% Processing: return add19
+	sw -52(r14),r3
+inline_4
+	% Processing: write func_call28
+	addi r14,r14,-48
+	sw -8(r14),r3
+	addi r3,r0,buf
+	sw -12(r14),r3
+	jl r15,intstr
+	sw -8(r14),r13
+	jl r15,putstr
+	subi r14,r14,-48
+	% Processing: function call to f
+	% Processing: function call to h
+	lw r3,-12(r14)
+	% Processing: intlit30 := 3
+	addi r2,r0,3
+	% Inlined call to h
+	% Processing: add19 := a - b
+	sub r2,r3,r2
+	% Processing: return add19
+	sw -52(r14),r2
+inline_5
+	lw r1,-8(r14)
+	sw -60(r14),r1
+	sw -64(r14),r3
+	% Processing: add29 := x + y
+	add r4,r1,r3
+	sw -68(r14),r4
+	sw -72(r14),r2
+	% Processing: intlit32 := 7
+	addi r2,r0,7
+	sw -76(r14),r2
+	% Processing: mult33 := x * y
+	mul r1,r1,r3
+	sw -80(r14),r1
+	addi r14,r14,-48
+	jl r15,g_f_a_b_c_d_e_g
+	lw r1,-4(r14)
+	% Processing: write func_call34
+	sw -8(r14),r1
+	addi r1,r0,buf
+	sw -12(r14),r1
+	jl r15,intstr
+	sw -8(r14),r13
+	jl r15,putstr
+	subi r14,r14,-48
+	% Processing: function call to f
+	% Processing: function call to h
+	lw r1,-8(r14)
+	% Processing: intlit35 := 1
+	addi r3,r0,1
+	% Inlined call to h
+	% Processing: add19 := a - b
+	sub r3,r1,r3
+	% Processing: return add19
+inline_6
+	% Processing: function call to h
+	% Processing: intlit37 := 2
+	addi r2,r0,2
+	lw r4,-12(r14)
+	% Inlined call to h
+	% Processing: add19 := a - b
+	sub r2,r2,r4
+	% Processing: return add19
+inline_7
+	% Processing: function call to h
+	% Inlined call to h
+	% Processing: add19 := a - b
+	sub r1,r1,r4
+	% Processing: return add19
+	sw -52(r14),r1
+inline_8
+	sw -48(r14),r1
+	sw -60(r14),r3
+	sw -64(r14),r2
+	% Processing: intlit39 := 3
+	addi r2,r0,3
+	sw -68(r14),r2
+	% Processing: intlit40 := 4
+	addi r2,r0,4
+	sw -72(r14),r2
+	sw -76(r14),r1
+	% Processing: intlit42 := 6
+	addi r1,r0,6
+	sw -80(r14),r1
+	addi r14,r14,-48
+	jl r15,g_f_a_b_c_d_e_g
+	lw r1,-4(r14)
+	subi r14,r14,-48
+	sw -28(r14),r1
+	% Processing: function call to f
+	% Processing: function call to h
+	% Processing: intlit49 := 6
+	addi r1,r0,6
+	lw r2,-8(r14)
+	% Inlined call to h
+	% Processing: add19 := a - b
+	sub r1,r1,r2
+	% Processing: return add19
+	sw -52(r14),r1
+inline_9
+	% Processing: intlit44 := 1
+	addi r2,r0,1
+	sw -60(r14),r2
+	% Processing: intlit45 := 2
+	addi r2,r0,2
+	sw -64(r14),r2
+	% Processing: intlit46 := 3
+	addi r2,r0,3
+	sw -68(r14),r2
+	% Processing: intlit47 := 4
+	addi r2,r0,4
+	sw -72(r14),r2
+	% Processing: intlit48 := 5
+	addi r2,r0,5
+	sw -76(r14),r2
+	sw -80(r14),r1
+	addi r14,r14,-48
+	jl r15,g_f_a_b_c_d_e_g
+	lw r1,-4(r14)
+	lw r2,20(r14)
+	% Processing: add52 := func_call43 + func_call51
+	add r2,r2,r1
+	% Processing: write add52
+	sw -8(r14),r2
+	addi r2,r0,buf
+	sw -12(r14),r2
+	jl r15,intstr
+	sw -8(r14),r13
+	jl r15,putstr
+	subi r14,r14,-48
+	% Processing: function call to k
+	lw r2,-24(r14)
+	sw -60(r14),r2
+	lw r2,-12(r14)
+	sw -64(r14),r2
+	% Inlined call to k
+	% Processing: add21 := x + intlit20
+	addi r2,r2,1
+	% Processing: return add21
+	sw -52(r14),r2
+inline_10
+	% Processing: write func_call53
+	addi r14,r14,-48
+	sw -8(r14),r2
+	addi r2,r0,buf
+	sw -12(r14),r2
+	jl r15,intstr
+	sw -8(r14),r13
+	jl r15,putstr
+	subi r14,r14,-48
+	hlt
+
+% This is used for printing
+buf       res 20
@@ -0,0 +1,297 @@
+% Function: sq
+g_sq_a
+	sw -8(r14),r15
+	lw r1,-12(r14)
+	% Processing: mult0 := a * a
+	mul r1,r1,r1
+	% Processing: return mult0
+	sw -4(r14),r1
+	lw r15,-8(r14)
+	jr r15
+% Function: add3
+g_add3_a_b_c
+	sw -8(r14),r15
+	lw r1,-12(r14)
+	lw r2,-16(r14)
+	% Processing: mult2 := b * intlit1
+	muli r2,r2,10
+	% Processing: add3 := a + mult2
+	add r1,r1,r2
+	lw r2,-20(r14)
+	% Processing: mult5 := c * intlit4
+	muli r2,r2,100
+	% Processing: add6 := add3 + mult5
+	add r1,r1,r2
+	% Processing: return add6
+	sw -4(r14),r1
+	lw r15,-8(r14)
+	jr r15
+% Function: fib
+g_fib_n
+	sw -8(r14),r15
+	lw r1,-12(r14)
+	% Processing: r := n
+	sw -16(r14),r1
+	% Processing: if statement
+	% Processing: relop8 := n > intlit7
+	cgti r2,r1,1
+	bz r2,end_if1
+	% Processing: function call to fib
+	% Processing: add10 := n - intlit9
+	subi r1,r1,1
+	sw -48(r14),r1
+	addi r14,r14,-36
+	jl r15,g_fib_n
+	lw r1,-4(r14)
+	sw 8(r14),r1
+	% Processing: function call to fib
+	lw r1,24(r14)
+	% Processing: add13 := n - intlit12
+	subi r1,r1,2
+	sw -12(r14),r1
+	jl r15,g_fib_n
+	lw r1,-4(r14)
+	subi r14,r14,-36
+	lw r2,-28(r14)
+	% Processing: add15 := func_call11 + func_call14
+	add r2,r2,r1
+	% Processing: r := add15
+	sw -16(r14),r2
+end_if1
+	lw r2,-16(r14)
+	% Processing: return r
+	sw -4(r14),r2
+	lw r15,-8(r14)
+	jr r15
+% Function: main
+entry
+	addi r14,r0,topaddr % Program starts here
+g_main
+	sw -4(r14),r15
+	% Processing: intlit16 := 3
+	% Processing: x := intlit16
+	% Processing: intlit17 := 4
+	% Processing: y := intlit17
+	% Processing: mult44 := 12432
+	addi r1,r0,12432
+	% Processing: z := mult44
+	% Processing: const14 := 12432
+	% Processing: write const14
+	addi r14,r14,-44
+	sw -8(r14),r1
+	addi r1,r0,buf
+	sw -12(r14),r1
+	jl r15,intstr
+	sw -8(r14),r13
+	jl r15,putstr
+	subi r14,r14,-44
+	% Processing: function call to sq
+	% Processing: function call to sq
+	% Processing: const16 := 4
+	addi r1,r0,4
+	% Inlined call to sq
+	% Processing: mult0 := a * a
+	mul r1,r1,r1
+	% Processing: return mult0
+inline_0
+	% Processing: add46 := const15 + func_call45
+	addi r2,r1,3
+	% Inlined call to sq
+	% Processing: mult0 := a * a
+	mul r2,r2,r2
+	% Processing: return mult0
+inline_1
+	% Processing: function call to sq
+	% Processing: function call to sq
+	% Processing: const17 := 3
+	addi r3,r0,3
+	% Inlined call to sq
+	% Processing: mult0 := a * a
+	mul r3,r3,r3
+	% Processing: return mult0
+inline_2
+	% Processing: add49 := func_call48 - const18
+	subi r3,r3,4
+	% Inlined call to sq
+	% Processing: mult0 := a * a
+	mul r3,r3,r3
+	% Processing: return mult0
+inline_3
+	% Processing: function call to add3
+	% Processing: function call to sq
+	% Processing: intlit51 := 2
+	addi r4,r0,2
+	% Inlined call to sq
+	% Processing: mult0 := a * a
+	mul r4,r4,r4
+	% Processing: return mult0
+inline_4
+	% Processing: function call to sq
+	% Processing: add55 := 4
+	% Inlined call to sq
+	% Processing: mult0 := a * a
+	% Processing: return mult0
+inline_5
+	sw -44(r14),r1
+	sw -56(r14),r4
+	% Processing: add53 := 7
+	addi r5,r0,7
+	sw -60(r14),r5
+	sw -64(r14),r1
+	% Inlined call to add3
+	% Processing: mult2 := b * intlit1
+	muli r5,r5,10
+	% Processing: add3 := a + mult2
+	add r4,r4,r5
+	% Processing: mult5 := c * intlit4
+	muli r1,r1,100
+	% Processing: add6 := add3 + mult5
+	add r4,r4,r1
+	% Processing: return add6
+	sw -48(r14),r4
+inline_6
+	% Processing: mult58 := func_call50 * func_call57
+	mul r3,r3,r4
+	% Processing: add59 := func_call47 + mult58
+	add r2,r2,r3
+	% Processing: z := add59
+	% Processing: write z
+	addi r14,r14,-44
+	sw -8(r14),r2
+	addi r2,r0,buf
+	sw -12(r14),r2
+	jl r15,intstr
+	sw -8(r14),r13
+	jl r15,putstr
+	subi r14,r14,-44
+	% Processing: function call to add3
+	% Processing: function call to add3
+	% Processing: intlit61 := 2
+	addi r2,r0,2
+	% Processing: intlit62 := 3
+	addi r3,r0,3
+	% Processing: intlit63 := 4
+	addi r4,r0,4
+	% Inlined call to add3
+	% Processing: mult2 := b * intlit1
+	muli r3,r3,10
+	% Processing: add3 := a + mult2
+	add r2,r2,r3
+	% Processing: mult5 := c * intlit4
+	muli r4,r4,100
+	% Processing: add6 := add3 + mult5
+	add r2,r2,r4
+	% Processing: return add6
+inline_7
+	% Processing: function call to sq
+	% Processing: function call to add3
+	% Processing: intlit65 := 1
+	addi r4,r0,1
+	% Processing: intlit66 := 1
+	% Processing: intlit67 := 1
+	% Inlined call to add3
+	% Processing: mult2 := b * intlit1
+	muli r3,r4,10
+	% Processing: add3 := a + mult2
+	add r3,r4,r3
+	% Processing: mult5 := c * intlit4
+	muli r1,r4,100
+	% Processing: add6 := add3 + mult5
+	add r3,r3,r1
+	% Processing: return add6
+inline_8
+	% Inlined call to sq
+	% Processing: mult0 := a * a
+	mul r3,r3,r3
+	% Processing: return mult0
+inline_9
+	% Processing: intlit60 := 1
+	sw -56(r14),r4
+	sw -60(r14),r2
+	sw -64(r14),r3
+	% Inlined call to add3
+	% Processing: mult2 := b * intlit1
+	muli r2,r2,10
+	% Processing: add3 := a + mult2
+	add r4,r4,r2
+	% Processing: mult5 := c * intlit4
+	muli r3,r3,100
+	% Processing: add6 := add3 + mult5
+	add r4,r4,r3
+	% Processing: return add6
+	sw -48(r14),r4
+inline_10
+	% Processing: write func_call70
+	addi r14,r14,-44
+	sw -8(r14),r4
+	addi r4,r0,buf
+	sw -12(r14),r4
+	jl r15,intstr
+	sw -8(r14),r13
+	jl r15,putstr
+	% Processing: function call to fib
+	% Processing: intlit71 := 10
+	addi r4,r0,10
+	sw -12(r14),r4
+	jl r15,g_fib_n
+	lw r4,-4(r14)
+	% Processing: write func_call72
+	sw -8(r14),r4
+	addi r4,r0,buf
+	sw -12(r14),r4
+	jl r15,intstr
+	sw -8(r14),r13
+	jl r15,putstr
+	% Processing: add81 := 29
+	addi r4,r0,29
+	% Processing: z := add81
+	% Processing: const30 := 29
+	% Processing: write const30
+	sw -8(r14),r4
+	addi r4,r0,buf
+	sw -12(r14),r4
+	jl r15,intstr
+	sw -8(r14),r13
+	jl r15,putstr
+	% Processing: function call to fib
+	% Processing: intlit84 := 5
+	addi r4,r0,5
+	sw -12(r14),r4
+	jl r15,g_fib_n
+	lw r4,-4(r14)
+	subi r14,r14,-44
+	% Processing: add86 := const35 + func_call85
+	addi r4,r4,4
+	% Processing: mult87 := add83 * add86
+	muli r4,r4,-1
+	% Processing: mult82 := 12
+	addi r3,r0,12
+	% Processing: add88 := mult82 - mult87
+	sub r3,r3,r4
+	% Processing: function call to sq
+	% Processing: const36 := 4
+	addi r4,r0,4
+	sw -56(r14),r4
+	% Inlined call to sq
+	% Processing: mult0 := a * a
+	mul r4,r4,r4
+	% Processing: return mult0
+	sw -48(r14),r4
+inline_11
+	% Processing: mult91 := func_call89 * add90
+	muli r4,r4,7
+	% Processing: add92 := add88 + mult91
+	add r3,r3,r4
+	% Processing: write add92
+	addi r14,r14,-44
+	sw -8(r14),r3
+	addi r3,r0,buf
+	sw -12(r14),r3
+	jl r15,intstr
+	sw -8(r14),r13
+	jl r15,putstr
+	subi r14,r14,-44
+	hlt
+
+% This is used for printing
+buf       res 20
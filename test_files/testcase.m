@@ -0,0 +1,75 @@
+% Function: get_value
+g_get_value
+	sw -8(r14),r15
+	% Processing: function call to get_num
+	% Processing: intlit0 := 5
+	addi r1,r0,5
+	% Inlined call to get_num
+	% Processing: return x
+inline_0
+	% Processing: return func_call1
+	sw -4(r14),r1
+	lw r15,-8(r14)
+	jr r15
+% Function: get_num
+g_get_num_x
+	sw -8(r14),r15
+	lw r1,-12(r14)
+	% Processing: return x
+	sw -4(r14),r1
+	lw r15,-8(r14)
+	jr r15
+% Function: main
+entry
+	addi r14,r0,topaddr % Program starts here
+g_main
+	sw -4(r14),r15
+	% Processing: function call to get_value
+	% Inlined call to get_value
+	% Processing: function call to get_num
+	% Processing: intlit0 := 5
+	addi r1,r0,5
+	sw -40(r14),r1
+	% Inlined call to get_num
+	% Processing: return x
+	sw -32(r14),r1
+inline_0_1
+	% Processing: return func_call1
+	sw -20(r14),r1
+inline_1
+	% Processing: x := func_call2
+	sw -8(r14),r1
+	% Processing: write x
+	addi r14,r14,-16
+	sw -8(r14),r1
+	addi r1,r0,buf
+	sw -12(r14),r1
+	jl r15,intstr
+	sw -8(r14),r13
+	jl r15,putstr
+	subi r14,r14,-16
+	% Processing: while loop
+	j while_test1
+while0
+	% Processing: add6 := x + intlit5
+	addi r2,r1,1
+	% Processing: x := add6
+	sw -8(r14),r2
+while_test1
+	lw r1,-8(r14)
+	% Processing: relop4 := x < intlit3
+	clti r2,r1,10
+	bnz r2,while0
+	% Processing: write x
+	addi r14,r14,-16
+	sw -8(r14),r1
+	addi r1,r0,buf
+	sw -12(r14),r1
+	jl r15,intstr
+	sw -8(r14),r13
+	jl r15,putstr
+	subi r14,r14,-16
+	hlt
+
+% This is used for printing
+buf       res 20
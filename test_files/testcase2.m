@@ -0,0 +1,67 @@
+% Function: add
+g_add_x_y
+	sw -8(r14),r15
+	lw r1,-12(r14)
+	lw r2,-16(r14)
+	% Processing: add0 := x + y
+	add r1,r1,r2
+	% Processing: return add0
+	sw -4(r14),r1
+	lw r15,-8(r14)
+	jr r15
+% Function: main
+entry
+	addi r14,r0,topaddr % Program starts here
+g_main
+	sw -4(r14),r15
+	% Processing: read input
+	addi r14,r14,-20
+	addi r1,r0,buf
+	sw -8(r14),r1
+	jl r15,getstr
+	addi r1,r0,buf
+	sw -8(r14),r1
+	jl r15,strint
+	subi r14,r14,-20
+	sw -12(r14),r13
+	% Processing: intlit1 := 5
+	addi r1,r0,5
+	% Processing: val := intlit1
+	% Processing: if statement
+	lw r2,-12(r14)
+	% Processing: relop2 := input > const0
+	cgti r3,r2,5
+	bz r3,else0
+	% Processing: const1 := 5
+	% Processing: result := const1
+	sw -16(r14),r1
+	j end_if1
+else0
+	% Processing: result := input
+	sw -16(r14),r2
+end_if1
+	% Processing: function call to add
+	lw r2,-16(r14)
+	sw -32(r14),r2
+	% Processing: intlit3 := 10
+	addi r1,r0,10
+	sw -36(r14),r1
+	% Inlined call to add
+	% Processing: add0 := x + y
+	add r2,r2,r1
+	% Processing: return add0
+	sw -24(r14),r2
+inline_0
+	% Processing: write func_call4
+	addi r14,r14,-20
+	sw -8(r14),r2
+	addi r2,r0,buf
+	sw -12(r14),r2
+	jl r15,intstr
+	sw -8(r14),r13
+	jl r15,putstr
+	subi r14,r14,-20
+	hlt
+
+% This is used for printing
+buf       res 20
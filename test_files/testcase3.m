@@ -0,0 +1,20 @@
+% Function: main
+entry
+	addi r14,r0,topaddr % Program starts here
+g_main
+	sw -4(r14),r15
+	% Processing: add6 := 13
+	addi r1,r0,13
+	% Processing: write add6
+	addi r14,r14,-4
+	sw -8(r14),r1
+	addi r1,r0,buf
+	sw -12(r14),r1
+	jl r15,intstr
+	sw -8(r14),r13
+	jl r15,putstr
+	subi r14,r14,-4
+	hlt
+
+% This is used for printing
+buf       res 20